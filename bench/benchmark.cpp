@@ -0,0 +1,558 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "benchmark.h"
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <cstdlib>
+#include <cerrno>
+#include <fstream>
+#include <iomanip>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+    #define VIVA_MALLOC_HOOKS
+#elif defined(__APPLE__)
+    #include <malloc/malloc.h>
+#elif defined(_WIN32)
+    #include <malloc.h>
+#endif
+
+
+//counters of the active AllocationScope
+static std::atomic<bool>    _scopeActive(false);
+static std::atomic<size_t>  _scopeAllocations(0);
+static std::atomic<size_t>  _scopeBytes(0);
+static std::atomic<int64_t> _scopeLive(0);
+static std::atomic<int64_t> _scopePeak(0);
+
+//addresses of the blocks allocated by the active scope (open addressing).
+//Only their release lowers the live bytes of the scope
+static const size_t    SCOPE_BLOCKS = 1 << 17;
+static const uintptr_t RELEASED     = 1;
+static std::atomic<uintptr_t> _scopeBlocks[SCOPE_BLOCKS];
+
+static size_t blockSize(void *ptr)
+{
+#if defined(__GLIBC__)
+    return malloc_usable_size(ptr);
+#elif defined(__APPLE__)
+    return malloc_size(ptr);
+#elif defined(_WIN32)
+    return _msize(ptr);
+#else
+    return 0;
+#endif
+}
+
+static size_t blockSlot(uintptr_t block)
+{
+    return (size_t)(((uint64_t)block >> 4) * 0x9E3779B97F4A7C15ull >> 47) & (SCOPE_BLOCKS - 1);
+}
+
+/*
+ * Records a block of the scope. When the table is full the block is never
+ * released from the live bytes, the peak is then an upper bound.
+ */
+static void track(void *ptr)
+{
+    uintptr_t block = (uintptr_t)ptr;
+    size_t i = blockSlot(block);
+    for (size_t n = 0; n < SCOPE_BLOCKS; ++n, i = (i + 1) & (SCOPE_BLOCKS - 1))
+    {
+        uintptr_t current = _scopeBlocks[i].load(std::memory_order_relaxed);
+        if ((current == 0 || current == RELEASED) &&
+            _scopeBlocks[i].compare_exchange_strong(current, block))
+            return;
+    }
+}
+
+/*
+ * Forgets a block of the scope. Returns false if it was allocated before the scope.
+ */
+static bool untrack(void *ptr)
+{
+    uintptr_t block = (uintptr_t)ptr;
+    size_t i = blockSlot(block);
+    for (size_t n = 0; n < SCOPE_BLOCKS; ++n, i = (i + 1) & (SCOPE_BLOCKS - 1))
+    {
+        uintptr_t current = _scopeBlocks[i].load(std::memory_order_relaxed);
+        if (current == 0)
+            return false;
+        if (current == block)
+            return _scopeBlocks[i].compare_exchange_strong(current, RELEASED);
+    }
+    return false;
+}
+
+/*
+ * The hooks must not allocate: only atomics are touched.
+ * Without an active scope they only check the flag.
+ */
+static void allocated(void *ptr)
+{
+    if (!ptr || !_scopeActive.load(std::memory_order_relaxed))
+        return;
+    track(ptr);
+    size_t size = blockSize(ptr);
+    _scopeAllocations++;
+    _scopeBytes += size;
+    int64_t live = (_scopeLive += (int64_t)size);
+    int64_t peak = _scopePeak.load(std::memory_order_relaxed);
+    while (live > peak && !_scopePeak.compare_exchange_weak(peak, live))
+        ;
+}
+
+static void released(void *ptr, size_t size)
+{
+    //blocks allocated before the scope are not part of its live bytes
+    if (ptr && _scopeActive.load(std::memory_order_relaxed) && untrack(ptr))
+        _scopeLive -= (int64_t)size;
+}
+
+static void released(void *ptr)
+{
+    if (ptr && _scopeActive.load(std::memory_order_relaxed))
+        released(ptr, blockSize(ptr));
+}
+
+#ifdef VIVA_MALLOC_HOOKS
+/*
+ * glibc: the malloc family of the process (operator new, OpenCV fastMalloc,
+ * the malloc calls of the trackers) is interposed by these definitions.
+ */
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void  __libc_free(void *ptr);
+    
+    void *malloc(size_t size)
+    {
+        void *ptr = __libc_malloc(size);
+        allocated(ptr);
+        return ptr;
+    }
+    void *calloc(size_t count, size_t size)
+    {
+        void *ptr = __libc_calloc(count, size);
+        allocated(ptr);
+        return ptr;
+    }
+    void *realloc(void *ptr, size_t size)
+    {
+        //the size is read before the call, the block is only released
+        //when it was moved or freed (size 0): a failed call keeps it live
+        size_t previous = (ptr && _scopeActive.load(std::memory_order_relaxed)) ? blockSize(ptr) : 0;
+        void *output = __libc_realloc(ptr, size);
+        if (output || size == 0)
+        {
+            released(ptr, previous);
+            allocated(output);
+        }
+        return output;
+    }
+    void *memalign(size_t alignment, size_t size)
+    {
+        void *ptr = __libc_memalign(alignment, size);
+        allocated(ptr);
+        return ptr;
+    }
+    void *aligned_alloc(size_t alignment, size_t size)
+    {
+        return memalign(alignment, size);
+    }
+    int posix_memalign(void **output, size_t alignment, size_t size)
+    {
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+        void *ptr = memalign(alignment, size);
+        if (!ptr)
+            return ENOMEM;
+        *output = ptr;
+        return 0;
+    }
+    void free(void *ptr)
+    {
+        released(ptr);
+        __libc_free(ptr);
+    }
+}
+#else
+/*
+ * Other platforms: only operator new is accounted
+ */
+void* operator new(size_t size)
+{
+    void *ptr = malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    allocated(ptr);
+    return ptr;
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void *ptr) noexcept
+{
+    released(ptr);
+    free(ptr);
+}
+void operator delete[](void *ptr) noexcept
+{
+    operator delete(ptr);
+}
+#endif
+
+void AllocationStats::accumulate(const AllocationStats &other)
+{
+    allocations += other.allocations;
+    bytes       += other.bytes;
+    peakBytes    = std::max(peakBytes, other.peakBytes);
+}
+
+AllocationScope::AllocationScope(AllocationStats &stats):
+_stats(stats)
+{
+    _scopeAllocations = 0;
+    _scopeBytes       = 0;
+    _scopeLive        = 0;
+    _scopePeak        = 0;
+    for (size_t i = 0; i < SCOPE_BLOCKS; ++i)
+        _scopeBlocks[i].store(0, std::memory_order_relaxed);
+    _scopeActive      = true;
+}
+
+AllocationScope::~AllocationScope()
+{
+    _scopeActive = false;
+    _stats.allocations = _scopeAllocations;
+    _stats.bytes       = _scopeBytes;
+    _stats.peakBytes   = (size_t)(int64_t)_scopePeak;
+}
+
+/*
+ * Value in KB of a field of /proc/self/status (e.g., VmRSS, VmHWM). 0 if not found.
+ */
+static long procStatus(const string &name)
+{
+    std::ifstream status("/proc/self/status");
+    string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, name.size(), name) == 0 && line.size() > name.size() && line[name.size()] == ':')
+            return std::atol(line.c_str() + name.size() + 1);
+    }
+    return 0;
+}
+
+long TrackerBenchmark::residentRSS()
+{
+#if defined(__linux__)
+    return procStatus("VmRSS");
+#else
+    return 0;
+#endif
+}
+
+long TrackerBenchmark::peakRSS()
+{
+#if defined(__linux__)
+    return procStatus("VmHWM");
+#elif !defined(_WIN32)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    #ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+    #else
+        return usage.ru_maxrss;
+    #endif
+#else
+    return 0;
+#endif
+}
+
+bool TrackerBenchmark::resetPeakRSS()
+{
+#if defined(__linux__)
+    //Linux 4.0+: writing 5 to clear_refs resets VmHWM to VmRSS
+    std::ofstream refs("/proc/self/clear_refs");
+    refs << "5";
+    refs.close();
+    return !refs.fail();
+#else
+    return false;
+#endif
+}
+
+double BenchmarkResult::percentile(double p) const
+{
+    if (latencies.empty())
+        return 0;
+    vector<double> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+    size_t index = (size_t)std::floor(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+double BenchmarkResult::mean() const
+{
+    if (latencies.empty())
+        return 0;
+    double sum = 0;
+    for (size_t i = 0; i < latencies.size(); ++i)
+        sum += latencies[i];
+    return sum / latencies.size();
+}
+
+double BenchmarkResult::fps() const
+{
+    double ms = mean();
+    return (ms > 0) ? 1000.0 / ms : 0;
+}
+
+bool TrackerBenchmark::loadSequence(const string &sequence, size_t maxFrames, BenchmarkSequence &output)
+{
+    output.name = sequence;
+    output.frames.clear();
+    output.groundTruth.clear();
+    
+    Ptr<Input> input = TrackerFactory::createInput(sequence);
+    TrackerFactory::findGroundTruth(sequence, output.groundTruth);
+    if (!input || output.groundTruth.empty())
+        return false;
+    
+    Mat frame;
+    while (output.frames.size() < maxFrames && input->getFrame(frame))
+        output.frames.push_back(frame.clone());
+    
+    return !output.frames.empty();
+}
+
+/*
+ * Untimed run of a new tracker instance accounting the heap activity of each call
+ */
+static bool instrument(const string &method, const BenchmarkSequence &sequence, const Rect &region,
+                       BenchmarkResult &result)
+{
+    const char *args[] = { method.c_str() };
+    Ptr<Tracker> tracker = TrackerFactory::createTracker(method, 1, args);
+    if (!tracker)
+        return false;
+    
+    {
+        AllocationScope scope(result.initAllocs);
+        tracker->initialize(sequence.frames[0], region);
+    }
+    for (size_t i = 1; i < sequence.frames.size(); ++i)
+    {
+        AllocationStats frame;
+        {
+            AllocationScope scope(frame);
+            tracker->processFrame(sequence.frames[i]);
+        }
+        result.frameAllocs.accumulate(frame);
+    }
+    
+    size_t frames = sequence.frames.size() - 1;
+    result.allocsPerFrame = (frames > 0) ? (double)result.frameAllocs.allocations / frames : 0;
+    result.instrumented   = true;
+    return true;
+}
+
+bool TrackerBenchmark::run(const string &method, const BenchmarkSequence &sequence, BenchmarkResult &result,
+                           bool allocations)
+{
+    result = BenchmarkResult();
+    result.tracker  = method;
+    result.sequence = sequence.name;
+    
+    const char *args[] = { method.c_str() };
+    Ptr<Tracker> tracker = TrackerFactory::createTracker(method, 1, args);
+    if (!tracker || sequence.frames.empty() || sequence.groundTruth.empty())
+        return false;
+    
+    Rect region = boundingRect(sequence.groundTruth[0]);
+    region.width  -= 1;
+    region.height -= 1;
+    
+    //the peak of the process includes the frames preloaded for every sequence,
+    //only the growth over the resident set before the run belongs to the tracker
+    bool peakReset  = resetPeakRSS();
+    long residentKB = residentRSS();
+    
+    auto start_time = chrono::high_resolution_clock::now();
+    tracker->initialize(sequence.frames[0], region);
+    auto end_time = chrono::high_resolution_clock::now();
+    result.initMs = chrono::duration<double, std::milli>(end_time - start_time).count();
+    
+    result.latencies.reserve(sequence.frames.size());
+    for (size_t i = 1; i < sequence.frames.size(); ++i)
+    {
+        start_time = chrono::high_resolution_clock::now();
+        tracker->processFrame(sequence.frames[i]);
+        end_time = chrono::high_resolution_clock::now();
+        result.latencies.push_back(chrono::duration<double, std::milli>(end_time - start_time).count());
+    }
+    result.peakRSSGrowth = peakReset ? std::max(0L, peakRSS() - residentKB) : -1;
+    tracker.release();
+    
+    return !allocations || instrument(method, sequence, region, result);
+}
+
+static string escape(const string &value)
+{
+    string out;
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        if (value[i] == '"' || value[i] == '\\')
+            out += '\\';
+        out += value[i];
+    }
+    return out;
+}
+
+void TrackerBenchmark::writeJSON(const vector<BenchmarkResult> &results, ostream &out)
+{
+    out << "{" << endl;
+    out << "  \"opencv\": \"" << CV_VERSION << "\"," << endl;
+    out << "  \"results\": [" << endl;
+    out << std::fixed << std::setprecision(4);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult &r = results[i];
+        out << "    {\"tracker\": \"" << escape(r.tracker) << "\""
+            << ", \"sequence\": \"" << escape(r.sequence) << "\""
+            << ", \"frames\": " << r.latencies.size() + 1
+            << ", \"init_ms\": " << r.initMs
+            << ", \"mean_ms\": " << r.mean()
+            << ", \"min_ms\": " << r.percentile(0)
+            << ", \"p50_ms\": " << r.percentile(50)
+            << ", \"p90_ms\": " << r.percentile(90)
+            << ", \"p99_ms\": " << r.percentile(99)
+            << ", \"max_ms\": " << r.percentile(100)
+            << ", \"fps\": " << r.fps()
+            << ", \"peak_rss_growth_kb\": " << r.peakRSSGrowth;
+        if (r.instrumented)
+            out << ", \"allocs_per_frame\": " << r.allocsPerFrame
+                << ", \"bytes_per_frame\": " << (r.latencies.empty() ? 0 : (double)r.frameAllocs.bytes / r.latencies.size())
+                << ", \"peak_frame_bytes\": " << r.frameAllocs.peakBytes
+                << ", \"init_allocs\": " << r.initAllocs.allocations
+                << ", \"init_bytes\": " << r.initAllocs.bytes
+                << ", \"init_peak_bytes\": " << r.initAllocs.peakBytes;
+        out << "}" << ((i + 1 < results.size()) ? "," : "") << endl;
+    }
+    out << "  ]" << endl;
+    out << "}" << endl;
+}
+
+/*
+ * Extracts the value of a field from a result line written by writeJSON.
+ */
+static bool field(const string &line, const string &key, string &value)
+{
+    string pattern = "\"" + key + "\": ";
+    size_t pos = line.find(pattern);
+    if (pos == string::npos)
+        return false;
+    pos += pattern.size();
+    if (line[pos] == '"')
+    {
+        value.clear();
+        for (++pos; pos < line.size() && line[pos] != '"'; ++pos)
+        {
+            if (line[pos] == '\\' && pos + 1 < line.size())
+                ++pos;
+            value += line[pos];
+        }
+        return true;
+    }
+    size_t end = line.find_first_of(",}", pos);
+    value = line.substr(pos, end - pos);
+    return true;
+}
+
+size_t TrackerBenchmark::compare(const vector<BenchmarkResult> &results,
+                                 const string &baseline,
+                                 double threshold,
+                                 ostream &report)
+{
+    std::ifstream infile(baseline.c_str());
+    if (!infile.is_open())
+    {
+        report << "baseline not found: " << baseline << endl;
+        return 0;
+    }
+    
+    size_t regressions = 0;
+    string line;
+    while (std::getline(infile, line))
+    {
+        string tracker, sequence, mean, p90;
+        if (!field(line, "tracker", tracker) || !field(line, "sequence", sequence) ||
+            !field(line, "mean_ms", mean) || !field(line, "p90_ms", p90))
+            continue;
+        
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchmarkResult &r = results[i];
+            if (r.tracker != tracker || r.sequence != sequence)
+                continue;
+            
+            double baseMean = atof(mean.c_str());
+            double baseP90  = atof(p90.c_str());
+            double currMean = r.mean();
+            double currP90  = r.percentile(90);
+            
+            if (currMean > baseMean * (1 + threshold) || currP90 > baseP90 * (1 + threshold))
+            {
+                regressions++;
+                report << "regression: " << tracker << " on " << sequence
+                       << " mean " << baseMean << " -> " << currMean << " ms,"
+                       << " p90 "  << baseP90  << " -> " << currP90  << " ms" << endl;
+            }
+        }
+    }
+    return regressions;
+}
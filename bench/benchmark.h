@@ -0,0 +1,191 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __bench__benchmark__
+#define __bench__benchmark__
+
+#include "factories.h"
+#include <functional>
+#include <chrono>
+#include <ostream>
+
+
+using namespace viva;
+using namespace std;
+using namespace cv;
+
+/**
+ * BenchmarkSequence struct
+ * Frames and ground-truth of a sequence decoded in memory before running the trackers,
+ * so decoding time is not included in the measurements.
+ */
+struct BenchmarkSequence
+{
+    string name;                            /**< sequence identifier*/
+    vector<Mat> frames;                     /**< decoded frames*/
+    vector<vector<Point2f> > groundTruth;   /**< ground-truth areas. Only the first one is used to initialize*/
+};
+
+/**
+ * AllocationStats struct
+ * Heap activity of the process while an AllocationScope is active
+ */
+struct AllocationStats
+{
+    size_t allocations;     /**< number of allocations (operator new, malloc, calloc, realloc, aligned)*/
+    size_t bytes;           /**< bytes allocated*/
+    size_t peakBytes;       /**< peak of the bytes allocated during the scope and not released yet*/
+    
+    AllocationStats():
+        allocations(0), bytes(0), peakBytes(0)
+    {}
+    
+    /**
+     * Adds the counters of other. The peak is the maximum of both.
+     */
+    void accumulate(const AllocationStats &other);
+};
+
+/**
+ * AllocationScope class
+ * Collects the allocations of every thread of the process during its lifetime.
+ * Only one scope can be active at a time. Releasing blocks allocated before the
+ * scope does not lower its live bytes. The heap hooks only check a flag while no
+ * scope is active.
+ */
+class AllocationScope
+{
+public:
+    explicit AllocationScope(AllocationStats &stats);
+    ~AllocationScope();
+    
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+private:
+    AllocationStats &_stats;
+};
+
+/**
+ * BenchmarkResult struct
+ * Performance measurements of one tracker over one sequence
+ */
+struct BenchmarkResult
+{
+    string tracker;             /**< tracking method identifier*/
+    string sequence;            /**< sequence identifier*/
+    double initMs;              /**< milliseconds spent in Tracker::initialize*/
+    vector<double> latencies;   /**< milliseconds spent in Tracker::processFrame for each frame*/
+    long   peakRSSGrowth;       /**< peak resident set size during the run over the one before it, in KB. -1 if not available*/
+    double allocsPerFrame;      /**< heap allocations per processed frame*/
+    AllocationStats initAllocs; /**< heap activity of Tracker::initialize*/
+    AllocationStats frameAllocs;/**< heap activity of Tracker::processFrame over all the frames. The peak is the largest of a single frame*/
+    bool   instrumented;        /**< whether the allocations were measured*/
+
+    BenchmarkResult():
+        tracker(), sequence(), initMs(0), latencies(), peakRSSGrowth(0), allocsPerFrame(0), initAllocs(), frameAllocs(),
+        instrumented(false)
+    {}
+
+    /**
+     * Latency value at the percentile p (0-100) of the processed frames
+     */
+    double percentile(double p) const;
+    /**
+     * Average latency per processed frame
+     */
+    double mean() const;
+    /**
+     * Processed frames per second
+     */
+    double fps() const;
+};
+
+/**
+ * TrackerBenchmark class
+ * Measures the initialization time, per-frame latency, memory and allocations
+ * of the trackers compiled in the project over a fixed set of sequences.
+ */
+class TrackerBenchmark
+{
+public:
+    /**
+     * Decodes up to maxFrames frames and the ground-truth of a sequence.
+     * @return false if the sequence has no frames or no ground-truth
+     */
+    static bool loadSequence(const string &sequence, size_t maxFrames, BenchmarkSequence &output);
+
+    /**
+     * Runs a tracker over a sequence and fills the measurements.
+     * The timed run has no allocation scope active. The allocations are measured
+     * in a second, untimed run of a new tracker instance.
+     * @param allocations: whether to run the allocation pass
+     * @return false if the tracker could not be created or the sequence is empty
+     */
+    static bool run(const string &method, const BenchmarkSequence &sequence, BenchmarkResult &result,
+                    bool allocations = false);
+
+    /**
+     * Writes the results in JSON format. One result object per line.
+     */
+    static void writeJSON(const vector<BenchmarkResult> &results, ostream &out);
+
+    /**
+     * Compares the results against a baseline written by writeJSON.
+     * A regression is reported when the mean or 90th percentile latency of a
+     * (tracker, sequence) pair is slower than the baseline by more than threshold (relative).
+     * @return number of regressions found
+     */
+    static size_t compare(const vector<BenchmarkResult> &results,
+                          const string &baseline,
+                          double threshold,
+                          ostream &report);
+
+    /**
+     * Resident set size of the process in KB. 0 if not available.
+     */
+    static long residentRSS();
+
+    /**
+     * Peak resident set size of the process in KB since the last resetPeakRSS. 0 if not available.
+     */
+    static long peakRSS();
+
+    /**
+     * Restarts the peak resident set size of the process from its current size.
+     * @return false if not supported, peakRSS is then the peak of the whole process
+     */
+    static bool resetPeakRSS();
+};
+
+#endif /* defined(__bench__benchmark__) */
@@ -0,0 +1,152 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "benchmark.h"
+#include <fstream>
+using namespace viva;
+
+
+int main(int argc, const char * argv[])
+{
+    const String keys =
+        "{help h            |           | print this message}"
+        "{@sequences        |           | comma separated list of sequences. Local datasets or synthetic sequences are used if empty}"
+        "{m methods         |           | comma separated list of trackers. All the compiled trackers if empty}"
+        "{f frames          |300        | maximum number of frames per sequence}"
+        "{k count           |3          | number of sequences taken from each local dataset}"
+        "{s synthetic       |           | use synthetic sequences even if local datasets are available}"
+        "{o output          |           | JSON output filename. Standard output if empty}"
+        "{b baseline        |           | JSON file from a previous run to compare against}"
+        "{t threshold       |0.1        | relative slowdown allowed before reporting a regression}"
+        "{a allocations     |           | count the heap allocations of every tracker call in a second, untimed run}"
+        "{trace             |           | chrome trace-event JSON file of the run (requires a WITH_TRACE build)}"
+    ;
+    
+    CommandLineParser parser(argc, argv, keys);
+    
+    if (parser.has("h"))
+    {
+        parser.printMessage();
+        return 0;
+    }
+    if (parser.has("trace"))
+        Trace::open(parser.get<string>("trace"));
+    
+    size_t maxFrames = parser.get<int>("f");
+    size_t perDataset = parser.get<int>("k");
+    
+    vector<string> methods;
+    if (parser.has("m"))
+        GroundTruth::split<string>(parser.get<string>("m"), ',', methods);
+    else
+        TrackerFactory::availableTrackers(methods);
+    
+    vector<string> names;
+    if (!parser.get<string>(0).empty())
+        GroundTruth::split<string>(parser.get<string>(0), ',', names);
+    else if (!parser.has("s"))
+    {
+        vector<string> datasets;
+        TrackerFactory::datasetSequences("", datasets);
+        string current;
+        size_t taken = 0;
+        for (size_t i = 0; i < datasets.size(); ++i)
+        {
+            string dataset = datasets[i].substr(0, datasets[i].find_first_of("/\\"));
+            if (dataset != current)
+            {
+                current = dataset;
+                taken = 0;
+            }
+            if (taken++ < perDataset)
+                names.push_back(datasets[i]);
+        }
+    }
+    
+    vector<BenchmarkSequence> sequences;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        BenchmarkSequence sequence;
+        if (TrackerBenchmark::loadSequence(names[i], maxFrames, sequence))
+            sequences.push_back(sequence);
+        else
+            cerr << "skipping sequence: " << names[i] << endl;
+    }
+    if (sequences.empty())
+    {
+        for (size_t i = 0; i < 3; ++i)
+        {
+            ostringstream name;
+            name << "synthetic:" << i << ":640x480:" << maxFrames;
+            sequences.push_back(BenchmarkSequence());
+            TrackerBenchmark::loadSequence(name.str(), maxFrames, sequences.back());
+        }
+    }
+    
+    vector<BenchmarkResult> results;
+    for (size_t m = 0; m < methods.size(); ++m)
+    {
+        for (size_t s = 0; s < sequences.size(); ++s)
+        {
+            BenchmarkResult result;
+            if (TrackerBenchmark::run(methods[m], sequences[s], result, parser.has("a")))
+            {
+                results.push_back(result);
+                cerr << methods[m] << " " << sequences[s].name << ": " << result.fps() << " fps";
+                if (result.instrumented)
+                    cerr << ", " << result.allocsPerFrame << " allocs/frame";
+                cerr << endl;
+            }
+            else
+                cerr << "unable to run " << methods[m] << " on " << sequences[s].name << endl;
+        }
+    }
+    
+    if (parser.has("o"))
+    {
+        std::ofstream outfile(parser.get<string>("o").c_str());
+        TrackerBenchmark::writeJSON(results, outfile);
+    }
+    else
+        TrackerBenchmark::writeJSON(results, cout);
+    
+    if (parser.has("b"))
+    {
+        size_t regressions = TrackerBenchmark::compare(results, parser.get<string>("b"),
+                                                       parser.get<double>("t"), cerr);
+        if (regressions > 0)
+            return 1;
+    }
+    return 0;
+}
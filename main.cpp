@@ -34,6 +34,10 @@
 
 #include "viva.h"
 #include "factories.h"
+#include "evaluation.h"
+#include "result_cache.h"
+#include "dataset_runner.h"
+#include "sharded_evaluation.h"
 #include <sstream>
 using namespace viva;
 
@@ -49,16 +53,99 @@ int main(int argc, const char * argv[])
         "{g groundtruth     |           | specify groundtruth file}"
         "{o output          |           | filename for tracking results}"
         "{v video           |           | output video filename / folder for images output}"
+        "{r reset           |           | supervised evaluation: re-initialize the tracker N frames after a failure (VOT uses -r=5). @sequence can be a comma separated list}"
+        "{j jobs            |0          | number of sequences evaluated in parallel with --reset or --dataset (0: all cores)}"
+        "{c cache           |           | folder caching the --reset results per tracker, options, build and sequence content}"
+        "{d dataset         |           | run every sequence listed by the dataset (e.g., --dataset=vot2015) headlessly with every method of -m (comma separated). -o is the results folder}"
+        "{w workers         |           | run --dataset in N worker processes (0: all cores). Safe for trackers with process-global state}"
+        "{shard             |0          | maximum frames per shard with --workers. The tracker is re-initialized at each shard (0: whole sequences)}"
+        "{trace             |           | chrome trace-event JSON file of the run (requires a WITH_TRACE build)}"
     ;
     
     CommandLineParser parser(argc, argv, keys);
 
     if (parser.has("h"))
             parser.printMessage();
+    else if (parser.has("trace"))
+        Trace::open(parser.get<string>("trace"));
 
     string sequence = parser.get<string>(0);
     string method   = parser.get<string>("m");
     string ofilename   = parser.get<string>("v");
+    int    jobs        = parser.get<int>("j");
+    
+    if (jobs < 0)
+    {
+        cerr << "jobs must be 0 (all cores) or a positive number" << endl;
+        return 1;
+    }
+    
+    if (!parser.has("h") && parser.has("d"))
+    {
+        vector<string> sequences, methods;
+        TrackerFactory::datasetSequences(parser.get<string>("d"), sequences);
+        GroundTruth::split<string>(method, ',', methods);
+        
+        DatasetRunner runner;
+        vector<RunResult> results;
+        auto creator = [&](const string &m) { return TrackerFactory::createTracker(m, argc, argv); };
+        if (parser.has("w"))
+        {
+            int workers = parser.get<int>("w");
+            int shard   = parser.get<int>("shard");
+            if (workers < 0 || shard < 0)
+            {
+                cerr << "workers and shard must be 0 or a positive number" << endl;
+                return 1;
+            }
+            
+            ShardedEvaluation sharded(workers, shard);
+            sharded.run(sequences, methods, creator, parser.get<string>("o"), results);
+            if (sharded.crashes() > 0)
+                cerr << sharded.crashes() << " worker processes crashed and were restarted" << endl;
+        }
+        else
+            runner.run(sequences, methods, creator, parser.get<string>("o"), results, jobs);
+        
+        runner.summary(results, cout);
+        if (parser.has("o"))
+        {
+            std::ofstream outfile((parser.get<string>("o") + Files::PATH_SEPARATOR + "summary.txt").c_str());
+            runner.summary(results, outfile);
+        }
+        return 0;
+    }
+    
+    if (!parser.has("h") && parser.has("r"))
+    {
+        vector<string> sequences;
+        GroundTruth::split<string>(sequence, ',', sequences);
+        
+        int reset = parser.get<int>("r");
+        if (reset < 0)
+        {
+            cerr << "reset must be 0 or a positive number of frames" << endl;
+            return 1;
+        }
+        
+        SupervisedConfig config(reset);
+        SupervisedEvaluation evaluation(config);
+        if (parser.has("c"))
+            evaluation.setCache(new ResultCache(parser.get<string>("c")),
+                                ResultCache::trackerKey(method, argc, argv));
+        vector<SupervisedResult> results;
+        evaluation.run(sequences, method,
+                       [&]() { return TrackerFactory::createTracker(method, argc, argv); },
+                       results, jobs);
+        
+        evaluation.summary(results, cout);
+        if (parser.has("o"))
+        {
+            std::ofstream outfile(parser.get<string>("o").c_str());
+            evaluation.summary(results, outfile);
+        }
+        return 0;
+    }
     
     Ptr<Input> input     = TrackerFactory::createInput(sequence);
     Ptr<Tracker> tracker = TrackerFactory::createTracker(method , argc, argv);
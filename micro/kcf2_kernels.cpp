@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "kernel_benchmark.h"
+
+#ifdef WITH_KCF2
+//relative path: kcf has a different fhog.hpp in the include path
+#include "../trackers/kcf2/fhog.hpp"
+#include "complexmat.hpp"
+#include <memory>
+
+/*
+ * Random spectrum of a window with the given number of channels
+ */
+static void randomSpectrum(const Size &size, int channels, ComplexMat &output)
+{
+    output = ComplexMat(size.height, size.width, channels);
+    for (int c = 0; c < channels; ++c)
+    {
+        Mat channel(size, CV_32FC2);
+        randu(channel, -1.f, 1.f);
+        output.set_channel(c, channel);
+    }
+}
+#endif
+
+void KernelBenchmark::addKCF2Kernels()
+{
+#ifdef WITH_KCF2
+    const int channels = 31;
+    
+    add("kcf2/FHoG::extract", [](const Size &size)
+    {
+        auto image = make_shared<Mat>(size, CV_32F);
+        auto fhog  = make_shared<FHoG>();
+        randu(*image, 0.f, 1.f);
+        
+        KernelOp op;
+        op.run   = [=]() { fhog->extract(*image, 2, 4, 9); };
+        op.bytes = (size.area() + 32 * size.area() / 16) * sizeof(float);
+        return op;
+    });
+    
+    add("kcf2/ComplexMat*ComplexMat", [=](const Size &size)
+    {
+        auto a = make_shared<ComplexMat>();
+        auto b = make_shared<ComplexMat>();
+        randomSpectrum(size, channels, *a);
+        randomSpectrum(size, channels, *b);
+        
+        KernelOp op;
+        op.run   = [=]() { ComplexMat c = (*a) * (*b); };
+        op.bytes = 3 * channels * size.area() * 2 * sizeof(float);
+        return op;
+    });
+    
+    add("kcf2/ComplexMat/ComplexMat", [=](const Size &size)
+    {
+        auto a = make_shared<ComplexMat>();
+        auto b = make_shared<ComplexMat>();
+        randomSpectrum(size, channels, *a);
+        randomSpectrum(size, channels, *b);
+        
+        KernelOp op;
+        op.run   = [=]() { ComplexMat c = (*a) / (*b); };
+        op.bytes = 3 * channels * size.area() * 2 * sizeof(float);
+        return op;
+    });
+    
+    add("kcf2/ComplexMat+scalar", [=](const Size &size)
+    {
+        auto a = make_shared<ComplexMat>();
+        randomSpectrum(size, channels, *a);
+        
+        KernelOp op;
+        op.run   = [=]() { ComplexMat c = (*a) + 1e-4f; };
+        op.bytes = 2 * channels * size.area() * 2 * sizeof(float);
+        return op;
+    });
+    
+    add("kcf2/ComplexMat::sqr_norm", [=](const Size &size)
+    {
+        auto a = make_shared<ComplexMat>();
+        randomSpectrum(size, channels, *a);
+        
+        KernelOp op;
+        op.run   = [=]() { a->sqr_norm(); };
+        op.bytes = channels * size.area() * 2 * sizeof(float);
+        return op;
+    });
+#endif
+}
@@ -0,0 +1,81 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "kernel_benchmark.h"
+
+#ifdef WITH_KCF
+//relative path: kcf2 has a different fhog.hpp in the include path
+#include "../trackers/kcf/fhog.hpp"
+#include <memory>
+
+/*
+ * Runs the FHOG stages of the kcf tracker up to the given one (1: getFeatureMaps,
+ * 2: normalizeAndTruncate, 3: PCAFeatureMaps). The stages modify the map in place,
+ * so the cost of each stage is the difference between consecutive kernels.
+ */
+static void kcfFeatures(const Mat &image, int stages)
+{
+    IplImage ipl = image;
+    CvLSVMFeatureMapCaskade *map;
+    getFeatureMaps(&ipl, 4, &map);
+    if (stages > 1)
+        normalizeAndTruncate(map, 0.2f);
+    if (stages > 2)
+        PCAFeatureMaps(map);
+    freeFeatureMapObject(&map);
+}
+#endif
+
+void KernelBenchmark::addKCFKernels()
+{
+#ifdef WITH_KCF
+    const char *names[] = { "kcf/getFeatureMaps",
+                            "kcf/getFeatureMaps+normalizeAndTruncate",
+                            "kcf/getFeatureMaps+normalizeAndTruncate+PCAFeatureMaps" };
+    for (int stages = 1; stages <= 3; ++stages)
+    {
+        add(names[stages - 1], [stages](const Size &size)
+        {
+            auto image = make_shared<Mat>(size, CV_8UC3);
+            randu(*image, 0, 255);
+            
+            KernelOp op;
+            op.run   = [=]() { kcfFeatures(*image, stages); };
+            //image and a map of 27 (31 after normalization) features per 4x4 cell
+            op.bytes = image->total() * image->elemSize() + 31 * (size.area() / 16) * sizeof(float);
+            return op;
+        });
+    }
+#endif
+}
@@ -0,0 +1,134 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "kernel_benchmark.h"
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+KernelBenchmark::KernelBenchmark():
+_kernels()
+{
+    addSKCFKernels();
+    addKCFKernels();
+    addKCF2Kernels();
+    addOpenTLDKernels();
+    addSTRUCKKernels();
+}
+
+void KernelBenchmark::add(const string &name, const KernelSetup &setup)
+{
+    _kernels.push_back(make_pair(name, setup));
+}
+
+void KernelBenchmark::names(vector<string> &output) const
+{
+    output.clear();
+    for (size_t i = 0; i < _kernels.size(); ++i)
+        output.push_back(_kernels[i].first);
+}
+
+bool KernelBenchmark::run(const string &name, const Size &size, double minSeconds, KernelResult &result) const
+{
+    size_t k = 0;
+    while (k < _kernels.size() && _kernels[k].first != name)
+        k++;
+    if (k == _kernels.size())
+        return false;
+    
+    result = KernelResult();
+    result.kernel = name;
+    result.size   = size;
+    
+    KernelOp op = _kernels[k].second(size);
+    if (!op.run)
+        return false;
+    
+    //warm-up: caches, lazy allocations of the outputs and DFT plans
+    op.run();
+    
+    double elapsed = 0;
+    size_t batch   = 1;
+    while (elapsed < minSeconds)
+    {
+        auto start_time = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < batch; ++i)
+            op.run();
+        auto end_time = chrono::high_resolution_clock::now();
+        elapsed += chrono::duration<double>(end_time - start_time).count();
+        result.iterations += batch;
+        batch *= 2;
+    }
+    
+    result.nsPerOp  = elapsed * 1e9 / result.iterations;
+    result.gbPerSec = (double)op.bytes * result.iterations / elapsed / 1e9;
+    return true;
+}
+
+void KernelBenchmark::writeTable(const vector<KernelResult> &results, ostream &out)
+{
+    out << std::left << setw(40) << "kernel" << setw(12) << "size"
+        << std::right << setw(14) << "ns/op" << setw(10) << "GB/s" << endl;
+    out << std::fixed;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const KernelResult &r = results[i];
+        ostringstream size;
+        size << r.size.width << "x" << r.size.height;
+        out << std::left << setw(40) << r.kernel << setw(12) << size.str()
+            << std::right << setw(14) << setprecision(1) << r.nsPerOp
+            << setw(10) << setprecision(3) << r.gbPerSec << endl;
+    }
+}
+
+void KernelBenchmark::writeJSON(const vector<KernelResult> &results, ostream &out)
+{
+    out << "{" << endl;
+    out << "  \"opencv\": \"" << CV_VERSION << "\"," << endl;
+    out << "  \"results\": [" << endl;
+    out << std::fixed << std::setprecision(4);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const KernelResult &r = results[i];
+        out << "    {\"kernel\": \"" << r.kernel << "\""
+            << ", \"width\": " << r.size.width
+            << ", \"height\": " << r.size.height
+            << ", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.nsPerOp
+            << ", \"gb_per_s\": " << r.gbPerSec
+            << "}" << ((i + 1 < results.size()) ? "," : "") << endl;
+    }
+    out << "  ]" << endl;
+    out << "}" << endl;
+}
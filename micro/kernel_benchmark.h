@@ -0,0 +1,133 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __micro__kernel_benchmark__
+#define __micro__kernel_benchmark__
+
+#include "precomp.h"
+#include "opencv2/core/core.hpp"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+/**
+ * KernelOp struct
+ * Call under measurement, with its inputs and outputs already allocated,
+ * and the bytes it reads and writes per call (used for the GB/s figure).
+ */
+struct KernelOp
+{
+    function<void()> run;   /**< one call of the kernel*/
+    size_t bytes;           /**< bytes read and written by one call*/
+    
+    KernelOp(): run(), bytes(0)
+    {}
+};
+
+/**
+ * KernelResult struct
+ * Measurement of one kernel for one window/image size
+ */
+struct KernelResult
+{
+    string kernel;          /**< kernel identifier*/
+    Size   size;            /**< window or image size*/
+    size_t iterations;      /**< calls measured*/
+    double nsPerOp;         /**< nanoseconds per call*/
+    double gbPerSec;        /**< bytes read and written per second, in GB*/
+    
+    KernelResult(): kernel(), size(), iterations(0), nsPerOp(0), gbPerSec(0)
+    {}
+};
+
+/**
+ * KernelBenchmark class
+ * Microbenchmarks of the numeric primitives of the trackers, measured in
+ * isolation over several window/image sizes. The kernels of each tracker
+ * are registered by its add*Kernels method (only for the enabled trackers).
+ */
+class KernelBenchmark
+{
+public:
+    /**
+     * Creates the inputs of a kernel for a size and returns the call to measure
+     */
+    typedef function<KernelOp(const Size &size)> KernelSetup;
+    
+    /**
+     * Registers the kernels of every tracker enabled in the build
+     */
+    KernelBenchmark();
+    
+    /**
+     * Registers a kernel
+     */
+    void add(const string &name, const KernelSetup &setup);
+    
+    /**
+     * Identifiers of the registered kernels
+     */
+    void names(vector<string> &output) const;
+    
+    /**
+     * Calls the kernel repeatedly for at least minSeconds after a warm-up call.
+     * @return false if the kernel is unknown
+     */
+    bool run(const string &name, const Size &size, double minSeconds, KernelResult &result) const;
+    
+    /**
+     * Writes the results as an aligned table
+     */
+    static void writeTable(const vector<KernelResult> &results, ostream &out);
+    
+    /**
+     * Writes the results in JSON format. One result object per line.
+     */
+    static void writeJSON(const vector<KernelResult> &results, ostream &out);
+    
+private:
+    vector<pair<string, KernelSetup> > _kernels;
+    
+    void addSKCFKernels();
+    void addKCFKernels();
+    void addKCF2Kernels();
+    void addOpenTLDKernels();
+    void addSTRUCKKernels();
+};
+
+#endif /* defined(__micro__kernel_benchmark__) */
@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "kernel_benchmark.h"
+#include "factories.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+using namespace viva;
+
+
+int main(int argc, const char * argv[])
+{
+    const String keys =
+        "{help h            |           | print this message}"
+        "{k kernels         |           | comma separated list of kernels (a prefix such as skcf/ selects a tracker). All the compiled kernels if empty}"
+        "{s sizes           |32,64,128,256| comma separated list of window/image sizes: N (NxN) or WxH}"
+        "{t time            |0.2        | minimum seconds measured per kernel and size}"
+        "{l list            |           | list the compiled kernels}"
+        "{o output          |           | JSON output filename}"
+    ;
+    
+    CommandLineParser parser(argc, argv, keys);
+    
+    if (parser.has("h"))
+    {
+        parser.printMessage();
+        return 0;
+    }
+    
+    KernelBenchmark bench;
+    vector<string> available;
+    bench.names(available);
+    
+    if (parser.has("l"))
+    {
+        for (size_t i = 0; i < available.size(); ++i)
+            cout << available[i] << endl;
+        return 0;
+    }
+    
+    vector<string> kernels, selected;
+    if (parser.has("k"))
+        GroundTruth::split<string>(parser.get<string>("k"), ',', selected);
+    for (size_t i = 0; i < available.size(); ++i)
+    {
+        bool match = selected.empty();
+        for (size_t j = 0; j < selected.size() && !match; ++j)
+            match = (available[i].compare(0, selected[j].size(), selected[j]) == 0);
+        if (match)
+            kernels.push_back(available[i]);
+    }
+    
+    vector<string> values;
+    vector<Size> sizes;
+    GroundTruth::split<string>(parser.get<string>("s"), ',', values);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        int width = 0, height = 0;
+        int read = sscanf(values[i].c_str(), "%dx%d", &width, &height);
+        if (read == 1)
+            height = width;
+        if (read < 1 || width <= 0 || height <= 0)
+        {
+            cerr << "invalid size: " << values[i] << endl;
+            return 1;
+        }
+        sizes.push_back(Size(width, height));
+    }
+    
+    double minSeconds = parser.get<double>("t");
+    vector<KernelResult> results;
+    for (size_t k = 0; k < kernels.size(); ++k)
+    {
+        for (size_t s = 0; s < sizes.size(); ++s)
+        {
+            KernelResult result;
+            if (bench.run(kernels[k], sizes[s], minSeconds, result))
+                results.push_back(result);
+            else
+                cerr << "unable to run " << kernels[k] << endl;
+        }
+    }
+    
+    KernelBenchmark::writeTable(results, cout);
+    if (parser.has("o"))
+    {
+        std::ofstream outfile(parser.get<string>("o").c_str());
+        KernelBenchmark::writeJSON(results, outfile);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "kernel_benchmark.h"
+
+#ifdef WITH_OPENTLD
+#include "DetectorCascade.h"
+#include "EnsembleClassifier.h"
+#include "IntegralImage.h"
+#include "NNClassifier.h"
+#include <memory>
+
+using namespace tld;
+#endif
+
+void KernelBenchmark::addOpenTLDKernels()
+{
+#ifdef WITH_OPENTLD
+    add("opentld/IntegralImage::calcIntImg", [](const Size &size)
+    {
+        auto image    = make_shared<Mat>(size, CV_8UC1);
+        auto integral = make_shared<IntegralImage<int> >(size);
+        randu(*image, 0, 255);
+        
+        KernelOp op;
+        op.run   = [=]() { integral->calcIntImg(*image); };
+        op.bytes = size.area() * (sizeof(unsigned char) + sizeof(int));
+        return op;
+    });
+    
+    //size.width is the number of patches of the model, half positive and half negative
+    add("opentld/NNClassifier::classifyPatch", [](const Size &size)
+    {
+        auto classifier = make_shared<NNClassifier>();
+        auto patch      = make_shared<NormalizedPatch>();
+        RNG rng(0);
+        for (int p = 0; p < size.width; ++p)
+        {
+            NormalizedPatch model;
+            for (int i = 0; i < TLD_PATCH_SIZE * TLD_PATCH_SIZE; ++i)
+                model.values[i] = rng.uniform(-1.f, 1.f);
+            model.positive = (p % 2 == 0);
+            (model.positive ? classifier->truePositives : classifier->falsePositives)->push_back(model);
+        }
+        for (int i = 0; i < TLD_PATCH_SIZE * TLD_PATCH_SIZE; ++i)
+            patch->values[i] = rng.uniform(-1.f, 1.f);
+        
+        KernelOp op;
+        op.run   = [=]() { classifier->classifyPatch(patch.get()); };
+        op.bytes = (size.width + 1) * TLD_PATCH_SIZE * TLD_PATCH_SIZE * sizeof(float);
+        return op;
+    });
+    
+    //sliding windows of an object of a quarter of the image
+    add("opentld/EnsembleClassifier::classifyWindow", [](const Size &size)
+    {
+        auto image   = make_shared<Mat>(size, CV_8UC1);
+        auto cascade = make_shared<DetectorCascade>();
+        randu(*image, 0, 255);
+        cascade->imgWidth     = size.width;
+        cascade->imgHeight    = size.height;
+        cascade->imgWidthStep = (int)image->step;
+        cascade->objWidth     = std::max(cascade->minSize, size.width / 4);
+        cascade->objHeight    = std::max(cascade->minSize, size.height / 4);
+        cascade->init();
+        cascade->ensembleClassifier->nextIteration(*image);
+        
+        KernelOp op;
+        op.run   = [=]()
+        {
+            for (int w = 0; w < cascade->numWindows; ++w)
+                cascade->ensembleClassifier->classifyWindow(w);
+        };
+        //two pixels per feature and the posterior of each tree
+        op.bytes = (size_t)cascade->numWindows * cascade->numTrees * (2 * cascade->numFeatures + sizeof(float));
+        return op;
+    });
+#endif
+}
@@ -0,0 +1,149 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "kernel_benchmark.h"
+
+#ifdef WITH_SKCF
+#include "ktrackers.h"
+#include <memory>
+
+/*
+ * Random feature channels of a window (the FHOG features have 31 channels)
+ */
+static void randomChannels(const Size &size, size_t channels, vector<Mat> &output)
+{
+    output.resize(channels);
+    for (size_t c = 0; c < channels; ++c)
+    {
+        output[c].create(size, CV_32F);
+        randu(output[c], -0.5f, 0.5f);
+    }
+}
+#endif
+
+void KernelBenchmark::addSKCFKernels()
+{
+#ifdef WITH_SKCF
+    const size_t channels = 31;
+    
+    add("skcf/fft2", [=](const Size &size)
+    {
+        auto features = make_shared<vector<Mat> >();
+        auto spectrum = make_shared<vector<Mat> >();
+        randomChannels(size, channels, *features);
+        FHOGConfigParams params(KType::GAUSSIAN, false);
+        
+        KernelOp op;
+        op.run   = [=]() { KTrackers::fft2(*features, *spectrum, params); };
+        op.bytes = 2 * channels * size.area() * sizeof(float);
+        return op;
+    });
+    
+    add("skcf/gaussian_correlation", [=](const Size &size)
+    {
+        auto xf = make_shared<vector<Mat> >();
+        auto yf = make_shared<vector<Mat> >();
+        auto kf = make_shared<Mat>();
+        auto ws = make_shared<TWorkspace>();
+        FHOGConfigParams params(KType::GAUSSIAN, false);
+        randomChannels(size, channels, *xf);
+        randomChannels(size, channels, *yf);
+        KTrackers::fft2(*xf, params);
+        KTrackers::fft2(*yf, params);
+        
+        KernelOp op;
+        op.run   = [=]() { KTrackers::gaussian_correlation(*xf, *yf, params, *kf, *ws); };
+        op.bytes = (2 * channels + 1) * size.area() * sizeof(float);
+        return op;
+    });
+    
+    add("skcf/polynomial_correlation", [=](const Size &size)
+    {
+        auto xf = make_shared<vector<Mat> >();
+        auto yf = make_shared<vector<Mat> >();
+        auto kf = make_shared<Mat>();
+        auto ws = make_shared<TWorkspace>();
+        FHOGConfigParams params(KType::POLYNOMIAL, false);
+        randomChannels(size, channels, *xf);
+        randomChannels(size, channels, *yf);
+        KTrackers::fft2(*xf, params);
+        KTrackers::fft2(*yf, params);
+        
+        KernelOp op;
+        op.run   = [=]() { KTrackers::polynomial_correlation(*xf, *yf, params, *kf, *ws); };
+        op.bytes = (2 * channels + 1) * size.area() * sizeof(float);
+        return op;
+    });
+    
+    add("skcf/divSpectrums", [=](const Size &size)
+    {
+        auto a   = make_shared<vector<Mat> >();
+        auto dst = make_shared<Mat>();
+        FHOGConfigParams params(KType::GAUSSIAN, false);
+        randomChannels(size, 2, *a);
+        KTrackers::fft2(*a, params);
+        
+        KernelOp op;
+        op.run   = [=]() { KTrackers::divSpectrums((*a)[0], (*a)[1], *dst, params.flags, false, params.lambda); };
+        op.bytes = 3 * size.area() * sizeof(float);
+        return op;
+    });
+    
+    add("skcf/gradientMagnitude", [](const Size &size)
+    {
+        auto image = make_shared<Mat>(size, CV_32F);
+        auto M     = make_shared<Mat>();
+        auto O     = make_shared<Mat>();
+        randu(*image, 0.f, 1.f);
+        
+        KernelOp op;
+        op.run   = [=]() { gradientMagnitude(*image, *M, *O); };
+        op.bytes = 3 * size.area() * sizeof(float);
+        return op;
+    });
+    
+    add("skcf/fhog", [](const Size &size)
+    {
+        auto image    = make_shared<Mat>(size, CV_32F);
+        auto features = make_shared<vector<Mat> >();
+        randu(*image, 0.f, 1.f);
+        FHOGConfigParams params(KType::GAUSSIAN, false);
+        
+        KernelOp op;
+        op.run   = [=]() { fhog(*image, *features, params.cell_size, params.hog_orientations); };
+        op.bytes = (size.area() + 32 * size.area() / (params.cell_size * params.cell_size)) * sizeof(float);
+        return op;
+    });
+#endif
+}
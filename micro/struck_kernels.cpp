@@ -0,0 +1,93 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "kernel_benchmark.h"
+
+#ifdef WITH_STRUCK
+#include "Config.h"
+#include "ImageRep.h"
+#include "Sampler.h"
+#include "Sample.h"
+#include "HaarFeatures.h"
+#include "Kernels.h"
+#include "LaRank.h"
+#include <memory>
+
+/*
+ * Object of a quarter of the image at its centre
+ */
+static FloatRect centreBox(const Size &size)
+{
+    return FloatRect(size.width * 3 / 8.f, size.height * 3 / 8.f, size.width / 4.f, size.height / 4.f);
+}
+#endif
+
+void KernelBenchmark::addSTRUCKKernels()
+{
+#ifdef WITH_STRUCK
+    add("struck/ImageRep", [](const Size &size)
+    {
+        auto image = make_shared<Mat>(size, CV_8UC1);
+        randu(*image, 0, 255);
+        
+        KernelOp op;
+        op.run   = [=]() { ImageRep rep(*image, true, false); };
+        op.bytes = size.area() * (sizeof(unsigned char) + sizeof(int));
+        return op;
+    });
+    
+    //learner updated on a few frames, evaluated on the samples of the search radius
+    add("struck/LaRank::Eval", [](const Size &size)
+    {
+        auto config   = make_shared<Config>();
+        auto image    = make_shared<Mat>(size, CV_8UC1);
+        randu(*image, 0, 255);
+        auto rep      = make_shared<ImageRep>(*image, true, false);
+        auto features = make_shared<HaarFeatures>(*config);
+        auto kernel   = make_shared<GaussianKernel>(0.2);
+        auto learner  = make_shared<LaRank>(*config, *features, *kernel);
+        
+        FloatRect box = centreBox(size);
+        for (int i = 0; i < 5; ++i)
+            learner->Update(MultiSample(*rep, Sampler::RadialSamples(box, 2 * config->searchRadius, 5, 16)), 0);
+        auto sample  = make_shared<MultiSample>(*rep, Sampler::PixelSamples(box, config->searchRadius));
+        auto results = make_shared<vector<double> >();
+        
+        KernelOp op;
+        op.run   = [=]() { learner->Eval(*sample, *results); };
+        op.bytes = sample->GetRects().size() * features->GetCount() * sizeof(double);
+        return op;
+    });
+#endif
+}
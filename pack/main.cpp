@@ -0,0 +1,136 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "factories.h"
+using namespace viva;
+
+/**
+ * Packs a sequence into a container file. Image sequences keep their original
+ * files when the codec is "copy"; any other input is decoded and stored with the
+ * png (lossless) or raw codec.
+ */
+static bool packSequence(const string &sequence, const string &filename, const string &codec)
+{
+    vector<string> files;
+    const SequenceEntry *entry = TrackerFactory::manifest()->find(sequence);
+    if (entry != NULL)
+        files = entry->frames;
+    else if (Files::isDir(sequence))
+        Files::listImages(sequence, files);
+    
+    vector<vector<Point2f> > groundTruth;
+    TrackerFactory::findGroundTruth(sequence, groundTruth);
+    
+    PackedWriter writer(filename, (codec == "raw") ? PackedCodec::RAW : PackedCodec::PNG);
+    if (!writer.isOpen())
+        return false;
+    
+    size_t frames = 0;
+    if (codec == "copy" && !files.empty())
+    {
+        for (; frames < files.size(); ++frames)
+            if (!writer.writeEncoded(files[frames]))
+                return false;
+    }
+    else
+    {
+        Ptr<Input> input = TrackerFactory::createInput(sequence);
+        if (!input)
+            return false;
+        Mat frame;
+        for (; input->getFrame(frame); ++frames)
+            if (!writer.write(frame))
+                return false;
+    }
+    
+    ostringstream metadata;
+    metadata << "sequence: " << sequence << endl << "frames: " << frames << endl << "codec: " << codec << endl;
+    writer.setMetadata(metadata.str());
+    writer.setGroundTruth(groundTruth);
+    return writer.close() && frames > 0;
+}
+
+int main(int argc, const char * argv[])
+{
+    const String keys =
+        "{help h            |           | print this message}"
+        "{@sequence         |           | sequence to pack: dataset/sequence, folder, video or synthetic sequence}"
+        "{@output           |           | container file (.vpk). Output folder when packing a whole dataset}"
+        "{c codec           |copy       | frame storage: copy (original image files), png (lossless, fast compression), raw (uncompressed)}"
+        "{d dataset         |           | pack every sequence of the dataset (e.g., vot2015) into the output folder}"
+    ;
+    
+    CommandLineParser parser(argc, argv, keys);
+    
+    // when a whole dataset is packed the only positional argument is the output folder
+    string output = parser.has("d") ? parser.get<string>(0) : parser.get<string>(1);
+    if (parser.has("h") || output.empty())
+    {
+        parser.printMessage();
+        return 0;
+    }
+    
+    string codec  = parser.get<string>("c");
+    
+    vector<string> sequences, filenames;
+    if (parser.has("d"))
+    {
+        TrackerFactory::datasetSequences(parser.get<string>("d"), sequences);
+        Files::makeDir(output);
+        for (size_t i = 0; i < sequences.size(); ++i)
+        {
+            string name;
+            Files::getFilename(sequences[i], name);
+            filenames.push_back(output + Files::PATH_SEPARATOR + name + ".vpk");
+        }
+    }
+    else
+    {
+        sequences.push_back(parser.get<string>(0));
+        filenames.push_back(output);
+    }
+    
+    int errors = 0;
+    for (size_t i = 0; i < sequences.size(); ++i)
+    {
+        if (packSequence(sequences[i], filenames[i], codec))
+            cerr << sequences[i] << " -> " << filenames[i] << endl;
+        else
+        {
+            cerr << "unable to pack sequence: " << sequences[i] << endl;
+            errors++;
+        }
+    }
+    return (errors > 0) ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "factories.h"
+#include "sweep.h"
+#include <fstream>
+using namespace viva;
+
+
+int main(int argc, const char * argv[])
+{
+    const String keys =
+        "{help h            |           | print this message}"
+        "{@sequences        |           | comma separated list of sequences. Dataset or synthetic sequences are used if empty}"
+        "{m method          |skcf       | tracking method}"
+        "{s space           |           | search space, e.g., padding=1.5,2,2.5;lambda=1e-5:1e-3:3:log;cell=1:4}"
+        "{n samples         |0          | number of random configurations. The whole grid is evaluated if 0}"
+        "{seed              |0          | seed of the random search}"
+        "{d dataset         |           | evaluate every sequence listed by the dataset, e.g., vot2015}"
+        "{r reset           |5          | frames skipped before re-initializing the tracker after a failure}"
+        "{j jobs            |0          | number of configurations evaluated in parallel (0: all cores). Their fps are measured under load}"
+        "{t retime          |           | evaluate the Pareto front again one configuration at a time to measure unloaded fps}"
+        "{o output          |           | filename for the Pareto table. Standard output if empty}"
+    ;
+    
+    CommandLineParser parser(argc, argv, keys);
+    
+    SweepSpace space;
+    if (parser.has("h") || !space.parse(parser.get<string>("s")))
+    {
+        parser.printMessage();
+        return 0;
+    }
+    
+    string method = parser.get<string>("m");
+    int    reset  = parser.get<int>("r");
+    int    jobs   = parser.get<int>("j");
+    
+    if (reset < 0)
+    {
+        cerr << "reset must be 0 or a positive number of frames" << endl;
+        return 1;
+    }
+    if (jobs < 0)
+    {
+        cerr << "jobs must be 0 (all cores) or a positive number" << endl;
+        return 1;
+    }
+    
+    vector<string> sequences;
+    if (!parser.get<string>(0).empty())
+        GroundTruth::split<string>(parser.get<string>(0), ',', sequences);
+    else if (parser.has("d"))
+        TrackerFactory::datasetSequences(parser.get<string>("d"), sequences);
+    if (sequences.empty())
+    {
+        for (size_t i = 0; i < 3; ++i)
+        {
+            ostringstream name;
+            name << "synthetic:" << i;
+            sequences.push_back(name.str());
+        }
+    }
+    
+    vector<SweepSpace::Configuration> configurations;
+    if (parser.get<int>("n") > 0)
+        space.random(parser.get<int>("n"), parser.get<int>("seed"), configurations);
+    else
+        space.grid(configurations);
+    
+    //trackers with process-global state can not run concurrently
+    if (!TrackerFactory::isThreadSafe(method))
+        jobs = 1;
+    
+    cerr << configurations.size() << " configurations of " << method << " over "
+         << sequences.size() << " sequences" << endl;
+    
+    SupervisedConfig config(reset);
+    ParameterSweep sweep(config);
+    vector<SweepResult> results;
+    sweep.run(method, sequences, configurations, results, jobs, parser.has("t"));
+    
+    if (parser.has("o"))
+    {
+        std::ofstream outfile(parser.get<string>("o").c_str());
+        ParameterSweep::table(results, outfile);
+    }
+    else
+        ParameterSweep::table(results, cout);
+    return 0;
+}
@@ -0,0 +1,214 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "dataset_runner.h"
+#include "factories.h"
+#include <iomanip>
+
+/*
+ * Creates every folder of the path that does not exist yet
+ */
+static void makePath(const string &path)
+{
+    for (size_t i = path.find_first_of("/\\", 1); i != string::npos; i = path.find_first_of("/\\", i + 1))
+        Files::makeDir(path.substr(0, i));
+    Files::makeDir(path);
+}
+
+bool DatasetRunner::run(const Ptr<Input> &input,
+                        const vector<vector<Point2f> > &gt,
+                        const Ptr<Tracker> &tracker,
+                        vector<vector<Point2f> > &trajectory,
+                        RunResult &result)
+{
+    trajectory.clear();
+    result.frames = result.trackedFrames = 0;
+    result.initTime = result.trackTime = 0;
+    
+    if (!input || !tracker || gt.empty())
+        return false;
+    
+    Mat frame;
+    bool initialized = false;
+    while (input->getFrame(frame))
+    {
+        vector<Point2f> area;
+        if (!initialized)
+        {
+            size_t frameN = result.frames;
+            if (frameN < gt.size() && gt[frameN].size() >= 3)
+            {
+                auto start_time = chrono::high_resolution_clock::now();
+                tracker->initialize(frame, SupervisedEvaluation::initRegion(gt[frameN]));
+                auto end_time = chrono::high_resolution_clock::now();
+                result.initTime += chrono::duration<double>(end_time - start_time).count();
+                initialized = true;
+            }
+        }
+        else
+        {
+            auto start_time = chrono::high_resolution_clock::now();
+            tracker->processFrame(frame);
+            auto end_time = chrono::high_resolution_clock::now();
+            result.trackTime += chrono::duration<double>(end_time - start_time).count();
+            result.trackedFrames++;
+        }
+        if (initialized)
+            tracker->getTrackedArea(area);
+        trajectory.push_back(area);
+        result.frames++;
+    }
+    return result.frames > 0;
+}
+
+void DatasetRunner::write(const string &folder, const vector<vector<Point2f> > &trajectory, RunResult &result)
+{
+    string name = folder + Files::PATH_SEPARATOR + result.method + Files::PATH_SEPARATOR + result.sequence;
+    string base;
+    Files::getBasename(name, base);
+    makePath(base.substr(0, base.size() - 1));
+    result.output = name + ".txt";
+    GroundTruth::create(result.output, trajectory);
+}
+
+void DatasetRunner::run(const vector<string> &sequences,
+                        const vector<string> &methods,
+                        const TrackerCreator &creator,
+                        const string &folder,
+                        vector<RunResult> &results,
+                        size_t jobs)
+{
+    results.clear();
+    results.resize(sequences.size() * methods.size());
+    
+    if (jobs == 0)
+        jobs = ThreadBudget::share();
+    ThreadBudget::Lease lease(std::max((size_t)1, std::min(jobs, results.size())));
+    jobs = lease.threads();
+    //the OpenCV pool of every job is limited to its share, set once for the whole run
+    ThreadBudget::OpenCVThreads openCV(lease.share());
+    
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        ThreadBudget::Scope scope(lease.share());
+        for (size_t i = next++; i < results.size(); i = next++)
+        {
+            RunResult &result = results[i];
+            result.sequence = sequences[i / methods.size()];
+            result.method   = methods[i % methods.size()];
+            
+            Ptr<Input> input = TrackerFactory::createInput(result.sequence);
+            vector<vector<Point2f> > gt, trajectory;
+            TrackerFactory::findGroundTruth(result.sequence, gt);
+            
+            Ptr<Tracker> tracker;
+            {
+                lock_guard<mutex> guard(_creation);
+                tracker = creator(result.method);
+            }
+            
+            if (TrackerFactory::isThreadSafe(result.method))
+                run(input, gt, tracker, trajectory, result);
+            else
+            {
+                lock_guard<mutex> guard(_exclusive);
+                run(input, gt, tracker, trajectory, result);
+            }
+            
+            if (!folder.empty() && result.frames > 0)
+                write(folder, trajectory, result);
+        }
+    };
+    
+    vector<thread> workers;
+    for (size_t i = 1; i < jobs; ++i)
+        workers.push_back(thread(worker));
+    worker();
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+void DatasetRunner::summary(const vector<RunResult> &results, ostream &out)
+{
+    out << std::left << std::setw(32) << "sequence"
+        << std::setw(12) << "method"
+        << std::right << std::setw(10) << "frames"
+        << std::setw(10) << "init ms"
+        << std::setw(10) << "ms/frame"
+        << std::setw(10) << "fps" << endl;
+    
+    vector<string> methods;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const RunResult &r = results[i];
+        out << std::left << std::setw(32) << r.sequence
+            << std::setw(12) << r.method
+            << std::right << std::setw(10) << r.frames
+            << std::fixed << std::setprecision(2)
+            << std::setw(10) << 1000 * r.initTime
+            << std::setw(10) << ((r.trackedFrames > 0) ? 1000 * r.trackTime / r.trackedFrames : 0)
+            << std::setprecision(1)
+            << std::setw(10) << r.fps() << endl;
+        if (std::find(methods.begin(), methods.end(), r.method) == methods.end())
+            methods.push_back(r.method);
+    }
+    
+    out << endl;
+    out << std::left << std::setw(12) << "method"
+        << std::right << std::setw(10) << "sequences"
+        << std::setw(10) << "frames"
+        << std::setw(10) << "seconds"
+        << std::setw(10) << "fps" << endl;
+    for (size_t m = 0; m < methods.size(); ++m)
+    {
+        size_t sequences = 0, frames = 0, tracked = 0;
+        double time = 0, trackTime = 0;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            if (results[i].method != methods[m] || results[i].frames == 0)
+                continue;
+            sequences++;
+            frames  += results[i].frames;
+            tracked += results[i].trackedFrames;
+            time    += results[i].initTime + results[i].trackTime;
+            trackTime += results[i].trackTime;
+        }
+        out << std::left << std::setw(12) << methods[m]
+            << std::right << std::setw(10) << sequences
+            << std::setw(10) << frames
+            << std::setprecision(2) << std::setw(10) << time
+            << std::setprecision(1) << std::setw(10) << ((trackTime > 0) ? tracked / trackTime : 0) << endl;
+    }
+}
@@ -0,0 +1,130 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __trackers__dataset_runner__
+#define __trackers__dataset_runner__
+
+#include "evaluation.h"
+
+
+using namespace viva;
+using namespace std;
+using namespace cv;
+
+/**
+ * RunResult struct
+ * Timing of one tracker over one sequence, initialized from the ground-truth
+ * of the first frame and tracking until the end of the sequence.
+ */
+struct RunResult
+{
+    string sequence;        /**< sequence identifier*/
+    string method;          /**< tracking method identifier*/
+    string output;          /**< file with the tracked area of each frame*/
+    size_t frames;          /**< number of processed frames*/
+    double initTime;        /**< seconds spent in Tracker::initialize*/
+    double trackTime;       /**< seconds spent in Tracker::processFrame*/
+    size_t trackedFrames;   /**< number of calls to Tracker::processFrame*/
+
+    RunResult():
+        sequence(), method(), output(), frames(0), initTime(0), trackTime(0), trackedFrames(0)
+    {}
+
+    double fps() const
+    {
+        return (trackTime > 0) ? trackedFrames / trackTime : 0;
+    }
+};
+
+/**
+ * DatasetRunner class
+ * Headless runner of several trackers over many sequences.
+ * Every (sequence, tracker) pair is a job; jobs are spread across the cores and
+ * stream their frames, so memory is bounded by the number of jobs running at once.
+ * Trackers that are not thread-safe (see TrackerFactory::isThreadSafe: opentld, and struck
+ * through the shared rand() stream) never run concurrently.
+ */
+class DatasetRunner
+{
+public:
+    /**
+     * Function creating a new instance of a tracker each time it is called.
+     * Calls are serialized by the runner.
+     */
+    typedef function<Ptr<Tracker>(const string &method)> TrackerCreator;
+
+private:
+    mutex _creation;
+    mutex _exclusive;
+
+public:
+    DatasetRunner(): _creation(), _exclusive()
+    {}
+
+    /**
+     * Runs a tracker over a sequence. The tracker is initialized with the first annotated frame.
+     * @param trajectory: tracked area of each frame, empty before the initialization
+     * @return false if the sequence has no frames or no ground-truth
+     */
+    static bool run(const Ptr<Input> &input,
+                    const vector<vector<Point2f> > &gt,
+                    const Ptr<Tracker> &tracker,
+                    vector<vector<Point2f> > &trajectory,
+                    RunResult &result);
+
+    /**
+     * Runs every tracker over every sequence.
+     * @param folder: results are written to folder/method/sequence.txt (GroundTruth format). Not written if empty
+     * @param results: one result per (sequence, method) pair, sequence-major
+     * @param jobs: number of pairs processed concurrently. 0 uses all the cores
+     */
+    void run(const vector<string> &sequences,
+             const vector<string> &methods,
+             const TrackerCreator &creator,
+             const string &folder,
+             vector<RunResult> &results,
+             size_t jobs = 0);
+
+    /**
+     * Writes a trajectory to folder/method/sequence.txt and sets the output of the result.
+     */
+    static void write(const string &folder, const vector<vector<Point2f> > &trajectory, RunResult &result);
+
+    /**
+     * Writes the timing of every (sequence, method) pair followed by the totals per method.
+     */
+    static void summary(const vector<RunResult> &results, ostream &out);
+};
+
+#endif /* defined(__trackers__dataset_runner__) */
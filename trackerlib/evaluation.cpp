@@ -0,0 +1,306 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+
+#include "evaluation.h"
+#include "factories.h"
+#include "result_cache.h"
+#include <iomanip>
+
+
+/*
+ * An area is usable when it has at least three finite corners
+ * enclosing a non-zero area. VOT annotations use NaN for missing frames.
+ */
+static bool validArea(const vector<Point2f> &area)
+{
+    if (area.size() < 3)
+        return false;
+    for (size_t i = 0; i < area.size(); ++i)
+        if (!std::isfinite(area[i].x) || !std::isfinite(area[i].y))
+            return false;
+    return contourArea(area) > 0;
+}
+
+double SupervisedEvaluation::overlap(const vector<Point2f> &a, const vector<Point2f> &b)
+{
+    if (!validArea(a) || !validArea(b))
+        return 0;
+    
+    vector<Point2f> hullA, hullB, intersection;
+    convexHull(a, hullA);
+    convexHull(b, hullB);
+    
+    double areaA = contourArea(hullA);
+    double areaB = contourArea(hullB);
+    double inter = intersectConvexConvex(hullA, hullB, intersection, true);
+    double uni   = areaA + areaB - inter;
+    
+    return (uni > 0) ? std::max(0., inter / uni) : 0;
+}
+
+Rect SupervisedEvaluation::initRegion(const vector<Point2f> &area)
+{
+    Rect region = boundingRect(area);
+    region.width  -= 1;
+    region.height -= 1;
+    return region;
+}
+
+bool SupervisedEvaluation::run(const Ptr<Input> &input,
+                               const vector<vector<Point2f> > &gt,
+                               const Ptr<Tracker> &tracker,
+                               SupervisedResult &result) const
+{
+    result.frames = result.failures = result.validFrames = result.trackedFrames = 0;
+    result.accuracy = result.initTime = result.trackTime = 0;
+    result.segments.clear();
+    result.trajectory.clear();
+    
+    if (!input || !tracker || gt.empty())
+        return false;
+    
+    Mat frame;
+    size_t frameN     = 0;
+    size_t restart    = 0;  //next frame where the tracker can be (re)initialized
+    size_t sinceInit  = 0;  //frames processed since the last (re)initialization
+    bool initialized  = false;
+    double overlapSum = 0;
+    
+    while (frameN < gt.size() && input->getFrame(frame))
+    {
+        vector<Point2f> area;
+        bool annotated = validArea(gt[frameN]);
+        
+        if (!initialized)
+        {
+            if (frameN >= restart && annotated)
+            {
+                auto start_time = chrono::high_resolution_clock::now();
+                tracker->initialize(frame, initRegion(gt[frameN]));
+                auto end_time = chrono::high_resolution_clock::now();
+                result.initTime += chrono::duration<double>(end_time - start_time).count();
+                
+                result.segments.push_back(SupervisedSegment());
+                initialized = true;
+                sinceInit   = 0;
+            }
+        }
+        else
+        {
+            auto start_time = chrono::high_resolution_clock::now();
+            tracker->processFrame(frame);
+            auto end_time = chrono::high_resolution_clock::now();
+            result.trackTime += chrono::duration<double>(end_time - start_time).count();
+            result.trackedFrames++;
+        }
+        
+        if (initialized)
+        {
+            tracker->getTrackedArea(area);
+            float value = (float)overlap(area, gt[frameN]);
+            result.segments.back().overlaps.push_back(value);
+            
+            //the initialization frame can not fail. Missing annotations are not judged
+            if (sinceInit > 0 && annotated && value <= _config.failureOverlap)
+            {
+                result.failures++;
+                result.segments.back().failed = true;
+                initialized = false;
+                restart = frameN + _config.skipFrames;
+            }
+            else if (sinceInit >= _config.burnIn && annotated)
+            {
+                overlapSum += value;
+                result.validFrames++;
+            }
+            sinceInit++;
+        }
+        result.trajectory.push_back(area);
+        frameN++;
+    }
+    
+    result.frames   = frameN;
+    result.accuracy = (result.validFrames > 0) ? overlapSum / result.validFrames : 0;
+    return frameN > 0;
+}
+
+void SupervisedEvaluation::run(const vector<string> &sequences,
+                               const string &method,
+                               const TrackerCreator &creator,
+                               vector<SupervisedResult> &results,
+                               size_t jobs)
+{
+    results.clear();
+    results.resize(sequences.size());
+    
+    //trackers with process-global state run one sequence at a time
+    if (!TrackerFactory::isThreadSafe(method))
+        jobs = 1;
+    else if (jobs == 0)
+        jobs = ThreadBudget::share();
+    ThreadBudget::Lease lease(std::max((size_t)1, std::min(jobs, sequences.size())));
+    jobs = lease.threads();
+    //the OpenCV pool of every job is limited to its share, set once for the whole run
+    ThreadBudget::OpenCVThreads openCV(lease.share());
+    
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        ThreadBudget::Scope scope(lease.share());
+        for (size_t i = next++; i < sequences.size(); i = next++)
+        {
+            SupervisedResult &result = results[i];
+            result.sequence = sequences[i];
+            result.method   = method;
+            
+            string key;
+            if (_cache)
+            {
+                key = ResultCache::key(_trackerKey, _config, ResultCache::sequenceHash(sequences[i]));
+                if (_cache->load(key, result))
+                    continue;
+            }
+            
+            Ptr<Input> input = TrackerFactory::createInput(sequences[i]);
+            vector<vector<Point2f> > gt;
+            TrackerFactory::findGroundTruth(sequences[i], gt);
+            
+            Ptr<Tracker> tracker;
+            {
+                lock_guard<mutex> guard(_creation);
+                tracker = creator();
+            }
+            if (run(input, gt, tracker, result) && _cache)
+                _cache->store(key, result);
+        }
+    };
+    
+    vector<thread> workers;
+    for (size_t i = 1; i < jobs; ++i)
+        workers.push_back(thread(worker));
+    worker();
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+void SupervisedEvaluation::eaoCurve(const vector<SupervisedResult> &results, vector<double> &curve)
+{
+    size_t length = 0;
+    for (size_t r = 0; r < results.size(); ++r)
+        for (size_t s = 0; s < results[r].segments.size(); ++s)
+            length = std::max(length, results[r].segments[s].overlaps.size());
+    
+    curve.assign(length + 1, 0);
+    vector<size_t> counts(length + 1, 0);
+    
+    for (size_t r = 0; r < results.size(); ++r)
+    {
+        for (size_t s = 0; s < results[r].segments.size(); ++s)
+        {
+            const SupervisedSegment &segment = results[r].segments[s];
+            size_t last = segment.failed ? length : segment.overlaps.size();
+            double sum  = 0;
+            for (size_t n = 1; n <= last; ++n)
+            {
+                //after a failure the overlap is zero
+                if (n <= segment.overlaps.size())
+                    sum += segment.overlaps[n - 1];
+                curve[n]  += sum / n;
+                counts[n] += 1;
+            }
+        }
+    }
+    for (size_t n = 1; n <= length; ++n)
+        curve[n] = (counts[n] > 0) ? curve[n] / counts[n] : 0;
+}
+
+double SupervisedEvaluation::eao(const vector<SupervisedResult> &results) const
+{
+    vector<double> curve;
+    eaoCurve(results, curve);
+    if (curve.size() < 2)
+        return 0;
+    
+    size_t high = std::min(_config.eaoHigh, curve.size() - 1);
+    size_t low  = std::max((size_t)1, std::min(_config.eaoLow, high));
+    
+    double sum = 0;
+    for (size_t n = low; n <= high; ++n)
+        sum += curve[n];
+    return sum / (high - low + 1);
+}
+
+void SupervisedEvaluation::summary(const vector<SupervisedResult> &results, ostream &out) const
+{
+    size_t frames = 0, failures = 0, evaluated = 0;
+    double accuracy = 0, time = 0, tracked = 0;
+    
+    out << std::left << std::setw(32) << "sequence"
+        << std::right << std::setw(10) << "frames"
+        << std::setw(10) << "failures"
+        << std::setw(10) << "accuracy"
+        << std::setw(10) << "fps" << endl;
+    
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const SupervisedResult &r = results[i];
+        out << std::left << std::setw(32) << r.sequence
+            << std::right << std::setw(10) << r.frames
+            << std::setw(10) << r.failures
+            << std::setw(10) << std::fixed << std::setprecision(3) << r.accuracy
+            << std::setw(10) << std::setprecision(1) << r.fps() << endl;
+        
+        if (r.frames == 0)
+            continue;
+        evaluated++;
+        frames   += r.frames;
+        failures += r.failures;
+        accuracy += r.accuracy;
+        time     += r.trackTime;
+        tracked  += r.trackedFrames;
+    }
+    
+    out << endl;
+    out << "method:     " << (results.empty() ? "" : results[0].method) << endl;
+    out << "sequences:  " << evaluated << " (" << frames << " frames)" << endl;
+    out << std::setprecision(3);
+    out << "accuracy:   " << ((evaluated > 0) ? accuracy / evaluated : 0) << endl;
+    out << "failures:   " << failures << " ("
+        << ((frames > 0) ? 100.0 * failures / frames : 0) << " per 100 frames)" << endl;
+    out << "robustness: " << ((evaluated > 0) ? (double)failures / evaluated : 0)
+        << " failures per sequence" << endl;
+    out << "eao:        " << eao(results) << endl;
+    out << "fps:        " << std::setprecision(1) << ((time > 0) ? tracked / time : 0) << endl;
+}
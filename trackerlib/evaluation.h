@@ -0,0 +1,232 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __trackers__evaluation__
+#define __trackers__evaluation__
+
+#include "viva.h"
+#include "tracker.h"
+#include <functional>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+
+using namespace viva;
+using namespace std;
+using namespace cv;
+
+/**
+ * SupervisedConfig struct
+ * Parameters of the VOT-style supervised evaluation. A tracker is declared
+ * lost when its overlap with the ground-truth drops to failureOverlap or below.
+ * It is then re-initialized from the ground-truth skipFrames later.
+ */
+struct SupervisedConfig
+{
+    size_t skipFrames;      /**< frames skipped after a failure before re-initializing (VOT uses 5)*/
+    size_t burnIn;          /**< frames after each (re)initialization excluded from the accuracy (VOT uses 10)*/
+    double failureOverlap;  /**< overlap value at or below which a failure is declared*/
+    size_t eaoLow;          /**< lower bound of the sequence length interval averaged by the EAO*/
+    size_t eaoHigh;         /**< upper bound of the sequence length interval averaged by the EAO*/
+
+    SupervisedConfig(size_t skip = 5, size_t burn = 10):
+        skipFrames(skip), burnIn(burn), failureOverlap(0.0),
+        eaoLow(108), eaoHigh(371)
+    {}
+};
+
+/**
+ * SupervisedSegment struct
+ * Overlaps recorded from one (re)initialization of the tracker
+ * until its failure or the end of the sequence.
+ */
+struct SupervisedSegment
+{
+    vector<float> overlaps; /**< overlap with the ground-truth for each frame since the initialization*/
+    bool failed;            /**< whenever the segment ended with a tracking failure*/
+
+    SupervisedSegment(): overlaps(), failed(false)
+    {}
+};
+
+/**
+ * SupervisedResult struct
+ * Outcome of a supervised evaluation of one tracker over one sequence.
+ */
+struct SupervisedResult
+{
+    string sequence;        /**< sequence identifier as given to TrackerFactory::createInput*/
+    string method;          /**< tracking method identifier*/
+    size_t frames;          /**< number of evaluated frames*/
+    size_t failures;        /**< number of times the tracker was lost*/
+    size_t validFrames;     /**< number of frames counted in the accuracy*/
+    double accuracy;        /**< average overlap over the valid frames*/
+    double initTime;        /**< seconds spent in Tracker::initialize*/
+    double trackTime;       /**< seconds spent in Tracker::processFrame*/
+    size_t trackedFrames;   /**< number of calls to Tracker::processFrame*/
+    vector<SupervisedSegment> segments;      /**< one entry per (re)initialization*/
+    vector<vector<Point2f> > trajectory;     /**< tracked area per frame. Empty areas while the tracker was lost*/
+
+    SupervisedResult():
+        sequence(), method(), frames(0), failures(0), validFrames(0),
+        accuracy(0), initTime(0), trackTime(0), trackedFrames(0),
+        segments(), trajectory()
+    {}
+
+    /**
+     * Returns the tracking speed in frames per second
+     * (initialization frames excluded).
+     */
+    double fps() const
+    {
+        return (trackTime > 0) ? trackedFrames / trackTime : 0;
+    }
+};
+
+/**
+ * SupervisedEvaluation class
+ * Headless runner implementing the VOT reset-based methodology:
+ * the tracker is initialized from the ground-truth, a failure is declared
+ * when the tracked area does not overlap the ground-truth, and the tracker is
+ * re-initialized from the ground-truth some frames later.
+ * Sequences are evaluated in parallel, one tracker instance per sequence.
+ */
+class ResultCache;
+
+class SupervisedEvaluation
+{
+public:
+    /**
+     * Function creating a new tracker instance each time it is called.
+     * Calls are serialized by the evaluation.
+     */
+    typedef function<Ptr<Tracker>()> TrackerCreator;
+
+private:
+    SupervisedConfig _config;
+    mutex _creation;
+    Ptr<ResultCache> _cache;
+    string _trackerKey;
+
+public:
+
+    SupervisedEvaluation(const SupervisedConfig &config = SupervisedConfig()):
+        _config(config), _creation(), _cache(), _trackerKey()
+    {}
+
+    /**
+     * Results of the sequences are looked up in the cache before running the tracker
+     * and stored afterwards.
+     * @param cache: result cache, empty to disable it
+     * @param trackerKey: identifier of the tracker configuration, see ResultCache::trackerKey
+     */
+    void setCache(const Ptr<ResultCache> &cache, const string &trackerKey)
+    {
+        _cache = cache;
+        _trackerKey = trackerKey;
+    }
+
+    const SupervisedConfig &getConfig() const
+    {
+        return _config;
+    }
+
+    /**
+     * Evaluates a tracker over one sequence.
+     * @param input: sequence frames
+     * @param gt: ground-truth defined as a 2D list points
+     * @param tracker: tracker instance to evaluate. It will be (re)initialized as needed
+     * @param result: filled with the failures, accuracy, timing and trajectory
+     * @return false if the sequence could not be evaluated (no frames or no ground-truth)
+     */
+    bool run(const Ptr<Input> &input,
+             const vector<vector<Point2f> > &gt,
+             const Ptr<Tracker> &tracker,
+             SupervisedResult &result) const;
+
+    /**
+     * Evaluates a tracker over a list of sequences in parallel.
+     * Input and ground-truth are resolved using the TrackerFactory.
+     * Trackers that are not thread-safe (see TrackerFactory::isThreadSafe) are always
+     * evaluated one sequence at a time.
+     * @param sequences: list of sequence identifiers
+     * @param method: tracking method identifier, labels the results and selects the thread-safety
+     * @param creator: creates a new tracker instance for each sequence
+     * @param results: one result per sequence, in the same order
+     * @param jobs: number of sequences evaluated concurrently. 0 uses all the cores
+     */
+    void run(const vector<string> &sequences,
+             const string &method,
+             const TrackerCreator &creator,
+             vector<SupervisedResult> &results,
+             size_t jobs = 0);
+
+    /**
+     * Expected average overlap curve. Value N is the average overlap over the first N
+     * frames of every segment, where frames after a failure count as zero overlap.
+     * Segments that reached the end of the sequence without failing
+     * only contribute up to their length.
+     */
+    static void eaoCurve(const vector<SupervisedResult> &results, vector<double> &curve);
+
+    /**
+     * Expected average overlap: mean of the EAO curve over [eaoLow, eaoHigh].
+     * Shorter sequences use the available part of the interval.
+     */
+    double eao(const vector<SupervisedResult> &results) const;
+
+    /**
+     * Writes a table with the accuracy, failures and speed per sequence
+     * followed by the accuracy/robustness/EAO summary.
+     */
+    void summary(const vector<SupervisedResult> &results, ostream &out) const;
+
+    /**
+     * Intersection over union of two areas defined by their corners.
+     * Returns 0 if any of the areas is empty or degenerated.
+     */
+    static double overlap(const vector<Point2f> &a, const vector<Point2f> &b);
+
+    /**
+     * Axis-aligned initialization region for a ground-truth area.
+     * Same region used by the TrackingProcess when initialized from the ground-truth.
+     */
+    static Rect initRegion(const vector<Point2f> &area);
+};
+
+#endif /* defined(__trackers__evaluation__) */
@@ -33,6 +33,11 @@
  **************************************************************************************************/
 
 #include "factories.h"
+#include "build_id.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 
 
 string TrackerFactory::SEQ_BASE_FILE     = "sequences.txt";
@@ -54,41 +59,221 @@ void GroundTruth::create(const string &file, const vector<vector<Point2f> > &gt)
     outfile.close();
 }
 
-void GroundTruth::parse(const string &file, vector<vector<Point2f> > &gt)
+/**
+ * Parses a decimal floating point number. Faster than the stream operators,
+ * it does not allocate and it does not depend on the locale.
+ * Returns false if no number starts at p.
+ */
+static bool parseFloat(const char *&p, const char *end, float &value)
 {
-    gt.clear();
+    static const double POW10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
     
-    if (viva::Files::isFile(file))
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
     {
-        std::ifstream infile(file);
-        std::string line, base;
-        while (std::getline(infile, line))
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += (mantissa != 0);
+        }
+        else
+            exponent++;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += (mantissa != 0);
+                exponent--;
+            }
+        }
+    }
+    if (!any)
+    {
+        if (end - p >= 3 && (p[0] | 0x20) == 'n' && (p[1] | 0x20) == 'a' && (p[2] | 0x20) == 'n')
+        {
+            p += 3;
+            value = std::numeric_limits<float>::quiet_NaN();
+            return true;
+        }
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool negativeExp = false;
+        if (q < end && (*q == '-' || *q == '+'))
+            negativeExp = (*q++ == '-');
+        if (q < end && *q >= '0' && *q <= '9')
+        {
+            int e = 0;
+            for (; q < end && *q >= '0' && *q <= '9'; ++q)
+                e = std::min(e * 10 + (*q - '0'), 1000);
+            exponent += negativeExp ? -e : e;
+            p = q;
+        }
+    }
+    
+    double result = (double)mantissa;
+    for (; exponent > 22; exponent -= 22)
+        result *= POW10[22];
+    for (; exponent < -22; exponent += 22)
+        result /= POW10[22];
+    result = (exponent >= 0) ? result * POW10[exponent] : result / POW10[-exponent];
+    value = (float)(negative ? -result : result);
+    return true;
+}
+
+/*
+ * Sidecar layout: magic, size and modification time (ns) of the text file it was
+ * created from, number of frames and the corners of every frame.
+ */
+static const char GTB_MAGIC[4] = {'G', 'T', 'B', '2'};
+static const size_t GTB_HEADER = sizeof(GTB_MAGIC) + 2 * sizeof(int64_t) + sizeof(uint32_t);
+
+string GroundTruth::binaryFile(const string &file)
+{
+    size_t dot   = file.find_last_of('.');
+    size_t slash = file.find_last_of("/\\");
+    if (dot == string::npos || (slash != string::npos && dot < slash))
+        return file + ".gtb";
+    return file.substr(0, dot) + ".gtb";
+}
+
+bool GroundTruth::createBinary(const string &file)
+{
+    int64_t size, mtime;
+    vector<Point2f> corners;
+    if (!viva::Files::stamp(file, size, mtime) || !parse(file, corners))
+        return false;
+    
+    std::ofstream outfile(binaryFile(file).c_str(), std::ios::binary);
+    uint32_t frames = (uint32_t)(corners.size() / 4);
+    outfile.write(GTB_MAGIC, sizeof(GTB_MAGIC));
+    outfile.write((const char *)&size, sizeof(size));
+    outfile.write((const char *)&mtime, sizeof(mtime));
+    outfile.write((const char *)&frames, sizeof(frames));
+    outfile.write((const char *)corners.data(), corners.size() * sizeof(Point2f));
+    return outfile.good();
+}
+
+/*
+ * Loads the corners of the sidecar if it was created from the current content of file
+ */
+static bool parseBinary(const string &file, const string &binary, vector<Point2f> &corners)
+{
+    int64_t size, mtime;
+    if (binary == file || !viva::Files::stamp(file, size, mtime) || !viva::Files::isFile(binary))
+        return false;
+    
+    viva::MappedFile mapped(binary);
+    if (!mapped.isOpen() || mapped.size() < GTB_HEADER)
+        return false;
+    
+    const char *p = mapped.data();
+    int64_t  sourceSize, sourceTime;
+    uint32_t frames;
+    std::memcpy(&sourceSize, p + sizeof(GTB_MAGIC), sizeof(sourceSize));
+    std::memcpy(&sourceTime, p + sizeof(GTB_MAGIC) + sizeof(sourceSize), sizeof(sourceTime));
+    std::memcpy(&frames, p + sizeof(GTB_MAGIC) + 2 * sizeof(int64_t), sizeof(frames));
+    if (!std::equal(GTB_MAGIC, GTB_MAGIC + sizeof(GTB_MAGIC), p) ||
+        sourceSize != size || sourceTime != mtime ||
+        (mapped.size() - GTB_HEADER) / (4 * sizeof(Point2f)) != frames ||
+        (mapped.size() - GTB_HEADER) % (4 * sizeof(Point2f)) != 0)
+        return false;
+    
+    corners.resize((size_t)frames * 4);
+    std::memcpy(corners.data(), p + GTB_HEADER, corners.size() * sizeof(Point2f));
+    return true;
+}
+
+bool GroundTruth::parse(const string &file, vector<Point2f> &corners)
+{
+    corners.clear();
+    
+    if (parseBinary(file, binaryFile(file), corners))
+        return true;
+    
+    viva::MappedFile mapped(file);
+    if (!mapped.isOpen())
+        return false;
+    
+    const float NaN = std::numeric_limits<float>::quiet_NaN();
+    const char *p   = mapped.data();
+    const char *end = p + mapped.size();
+    // annotation lines are at least ~24 characters long
+    corners.reserve((mapped.size() / 24 + 1) * 4);
+    
+    while (p < end)
+    {
+        float values[8];
+        int n = 0;
+        bool valid = true;
+        while (p < end && *p != '\n')
         {
-            vector<float> values;
-            split<float>(line, ',', values);
-            vector<Point2f> points;
-            
-            if (values.size() == 4)
+            if (*p == ',' || *p == ' ' || *p == '\t' || *p == '\r')
             {
-                points = {
-                    Point2f(values[0], values[1]),
-                    Point2f(values[0] + values[2], values[1]),
-                    Point2f(values[0] + values[2], values[1] + values[3]),
-                    Point2f(values[0], values[1]+ values[3]) };
+                ++p;
+                continue;
             }
-            if (values.size() == 8)
+            float value;
+            if (!parseFloat(p, end, value))
             {
-                points = {
-                    Point2f(values[0], values[1]),
-                    Point2f(values[2], values[3]),
-                    Point2f(values[4], values[5]),
-                    Point2f(values[6], values[7]) };
+                valid = false;
+                while (p < end && *p != '\n')
+                    ++p;
+                break;
             }
-            
-            gt.push_back(points);
-            
+            if (n < 8)
+                values[n] = value;
+            n++;
+        }
+        if (p < end)
+            ++p;
+        
+        if (valid && n == 4)
+        {
+            corners.push_back(Point2f(values[0], values[1]));
+            corners.push_back(Point2f(values[0] + values[2], values[1]));
+            corners.push_back(Point2f(values[0] + values[2], values[1] + values[3]));
+            corners.push_back(Point2f(values[0], values[1] + values[3]));
         }
-        infile.close();
+        else if (valid && n == 8)
+        {
+            for (int k = 0; k < 8; k += 2)
+                corners.push_back(Point2f(values[k], values[k + 1]));
+        }
+        else
+            corners.insert(corners.end(), 4, Point2f(NaN, NaN));
+    }
+    return true;
+}
+
+void GroundTruth::parse(const string &file, vector<vector<Point2f> > &gt)
+{
+    gt.clear();
+    
+    vector<Point2f> corners;
+    if (!viva::Files::isFile(file) || !parse(file, corners))
+        return;
+    
+    gt.resize(corners.size() / 4);
+    for (size_t i = 0; i < gt.size(); i++)
+    {
+        const Point2f *frame = &corners[i * 4];
+        if (!std::isnan(frame[0].x))
+            gt[i].assign(frame, frame + 4);
     }
 }
 
@@ -107,18 +292,24 @@ bool TrackerFactory::isWebFile(const string &sequence)
 }
 bool TrackerFactory::isStringSequence(const string &sequence)
 {
-	char *res0 = new char[sequence.length() * 2];
-	char *res1 = new char[sequence.length() * 2];
-    sprintf(res0, sequence.c_str(), 0);
-    sprintf(res1, sequence.c_str(), 1);
-    string path0(res0);
-    string path1(res1);
-    return (viva::Files::isFile(path0) || viva::Files::isFile(path1));
+    if (sequence.find('%') == string::npos)
+        return false;
+    vector<char> buffer(sequence.length() + 32);
+    snprintf(buffer.data(), buffer.size(), sequence.c_str(), 0);
+    if (viva::Files::isFile(buffer.data()))
+        return true;
+    snprintf(buffer.data(), buffer.size(), sequence.c_str(), 1);
+    return viva::Files::isFile(buffer.data());
 }
 bool TrackerFactory::isFolderSequence(const string &sequence)
 {
     return (viva::Files::isDir(sequence));
 }
+bool TrackerFactory::isPackedSequence(const string &sequence)
+{
+    return sequence.size() > 4 && sequence.compare(sequence.size() - 4, 4, ".vpk") == 0 &&
+           viva::Files::isFile(sequence);
+}
 string TrackerFactory::constructSequenceFolder(const string &file, const string &sequence)
 {
 	std::ifstream infile;
@@ -143,6 +334,15 @@ string TrackerFactory::constructSequenceFolder(const string &file, const string
 
 Ptr<Input> TrackerFactory::createInput(const string &sequence)
 {
+    SyntheticConfig config;
+    if (SyntheticConfig::parse(sequence, config))
+    {
+        return new SyntheticInput(config);
+    }
+    if (isPackedSequence(sequence))
+    {
+        return new PackedInput(sequence);
+    }
     if (isVideoFile(sequence))
     {
         return new VideoInput(sequence);
@@ -168,6 +368,11 @@ Ptr<Input> TrackerFactory::createInput(const string &sequence)
         return new WebStreamInput(std::stoi(sequence));
     }
 
+    const SequenceEntry *entry = findDatasetSequence(sequence);
+    if (entry != NULL)
+    {
+        return new ImageListInput(entry->frames, Size(-1,-1), -1, 0);
+    }
     string path = constructSequenceFolder(SEQ_BASE_FILE, sequence);
     if (isFolderSequence(path))
     {
@@ -190,20 +395,66 @@ Ptr<Output> TrackerFactory::createOutput(const string &filename)
 }
 
 
-Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc, const char * argv[])
+String TrackerFactory::trackerKeys(const string &method)
 {
-    Ptr<Tracker> tracker;
-    argv[0] = method.c_str();
 #ifdef WITH_SKCF
     if (method == "skcf")
-    {
-        const String keys =
+        return
         "{? usage           |       | print this message}"
         "{t type            |g      | correlation type: g(gaussian), p(polynomial), l(linear)}"
         "{f feat            |fhog   | feature type: fhog, gray, rgb, hsv, hls}"
+        "{s scale           |       | turn on scale estimation}"
+        "{scale_method      |flow   | scale estimation: flow (sparse keypoints), dsst (scale space filter)}"
+        "{padding           |       | extra area surrounding the target. Feature default if empty}"
+        "{lambda            |       | regularization. Feature default if empty}"
+        "{interp            |       | interpolation factor of the model adaptation. Feature default if empty}"
+        "{cell              |       | cell size of the features. Feature default if empty}"
+        "{serial            |       | run the channel loops on the calling thread (multi-target runs)}"
+        "{complex           |       | full complex spectrums instead of the CCS packed format}";
+#endif
+#ifdef WITH_NCC
+    if (method == "ncc")
+        return
+        "{? usage           |       | print this message}";
+#endif
+#ifdef WITH_KCF
+    if (method == "kcf")
+        return
+        "{? usage           |       | print this message}"
+        "{f feat            |hog    | feature type: hog, lab, gray}"
         "{s scale           |       | turn on scale estimation}";
-        
-        CommandLineParser parser(argc, argv, keys);
+#endif
+#ifdef WITH_KCF2
+    if (method == "kcf2")
+        return
+        "{? usage           |       | print this message}";
+#endif
+#ifdef WITH_STRUCK
+    if (method == "struck")
+        return
+        "{? usage           |       | print this message}"
+        "{radius            |30     | search radius in pixels}"
+        "{svmc              |100    | SVM regularization C}"
+        "{budget            |100    | SVM budget size (support vectors)}";
+#endif
+#ifdef WITH_OPENTLD
+    if (method == "opentld")
+        return
+        "{? usage           |       | print this message}"
+        "{trees             |10     | number of trees of the ensemble classifier}"
+        "{features          |10     | number of pixel comparisons per tree}";
+#endif
+    return "{? usage           |       | print this message}";
+}
+
+Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc, const char * argv[])
+{
+    Ptr<Tracker> tracker;
+    argv[0] = method.c_str();
+#ifdef WITH_SKCF
+    if (method == "skcf")
+    {
+        CommandLineParser parser(argc, argv, trackerKeys(method));
         
         KType type;
         KFeat feat;
@@ -226,7 +477,25 @@ Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc,
         else
             feat = KFeat::FHOG;
         
-        tracker = new SKCFDCF(KType::GAUSSIAN, KFeat::FHOG, parser.has("s"));
+        Ptr<SKCFDCF> skcf = new SKCFDCF(type, feat, parser.has("s"));
+        ConfigParams &params = skcf->getParams();
+        if (parser.has("padding"))
+            params.padding = parser.get<float>("padding");
+        if (parser.has("lambda"))
+            params.lambda = parser.get<float>("lambda");
+        if (parser.has("interp"))
+            params.interp_factor = parser.get<float>("interp");
+        if (parser.has("cell"))
+            params.cell_size = parser.get<int>("cell");
+        if (parser.get<string>("scale_method") == "dsst")
+            params.scale_type = KScaleType::DSST;
+        if (parser.has("serial"))
+            params.parallel = false;
+        //the filter is specialized for the kernel, feature and layout
+        //of these parameters when the target is set
+        if (parser.has("complex"))
+            params.flags = DFT_COMPLEX_OUTPUT;
+        tracker = skcf;
         
         if (parser.has("?"))
         {
@@ -241,10 +510,7 @@ Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc,
 #ifdef WITH_NCC
     if (method == "ncc")
     {
-        const String keys =
-        "{? usage           |       | print this message}";
-        
-        CommandLineParser parser(argc, argv, keys);
+        CommandLineParser parser(argc, argv, trackerKeys(method));
         
         tracker = new NCCTracker();
         
@@ -259,12 +525,7 @@ Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc,
 #ifdef WITH_KCF
     if (method == "kcf")
     {
-        const String keys =
-        "{? usage           |       | print this message}"
-        "{f feat            |hog    | feature type: hog, lab, gray}"
-        "{s scale           |       | turn on scale estimation}";
-        
-        CommandLineParser parser(argc, argv, keys);
+        CommandLineParser parser(argc, argv, trackerKeys(method));
         
         
         bool HOG = true;
@@ -300,10 +561,7 @@ Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc,
 #ifdef WITH_KCF2
     if (method == "kcf2")
     {
-        const String keys =
-        "{? usage           |       | print this message}";
-        
-        CommandLineParser parser(argc, argv, keys);
+        CommandLineParser parser(argc, argv, trackerKeys(method));
         
         
         tracker = new KCF_Tracker();
@@ -318,12 +576,11 @@ Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc,
 #ifdef WITH_STRUCK
     if (method == "struck")
     {
-        const String keys =
-        "{? usage           |       | print this message}";
+        CommandLineParser parser(argc, argv, trackerKeys(method));
         
-        CommandLineParser parser(argc, argv, keys);
-        
-        tracker = new STRUCKtracker();
+        Ptr<STRUCKtracker> struck = new STRUCKtracker();
+        struck->configure(parser.get<int>("radius"), parser.get<double>("svmc"), parser.get<int>("budget"));
+        tracker = struck;
         if (parser.has("?"))
         {
             parser.about(tracker->getDescription());
@@ -335,12 +592,9 @@ Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc,
 #ifdef WITH_OPENTLD
     if (method == "opentld")
     {
-        const String keys =
-        "{? usage           |       | print this message}";
+        CommandLineParser parser(argc, argv, trackerKeys(method));
         
-        CommandLineParser parser(argc, argv, keys);
-        
-        tracker = new OpenTLD();
+        tracker = new OpenTLD(parser.get<int>("trees"), parser.get<int>("features"));
         
         if (parser.has("?"))
         {
@@ -355,6 +609,110 @@ Ptr<Tracker> TrackerFactory::createTracker(const string &method, const int argc,
 
     return tracker;
 }
+string TrackerFactory::trackerOptions(const string &method, const int argc, const char * argv[])
+{
+    String keys = trackerKeys(method);
+    CommandLineParser parser(argc, argv, keys);
+    
+    ostringstream options;
+    for (size_t begin = keys.find('{'); begin != string::npos; begin = keys.find('{', begin + 1))
+    {
+        std::istringstream iss(keys.substr(begin + 1, keys.find('|', begin) - begin - 1));
+        string name;
+        if ((iss >> name) && name != "?")
+            options << name << "=" << (parser.has(name) ? parser.get<string>(name) : "") << ";";
+    }
+    return options.str();
+}
+string TrackerFactory::buildIdentifier(const string &method)
+{
+    vector<string> builds;
+    GroundTruth::split<string>(TRACKERS_BUILD, ';', builds);
+    for (size_t i = 0; i < builds.size(); ++i)
+    {
+        if (builds[i].compare(0, method.size() + 1, method + ":") == 0)
+            return builds[i].substr(method.size() + 1);
+    }
+    return "";
+}
+void TrackerFactory::availableTrackers(vector<string> &methods)
+{
+    methods.clear();
+#ifdef WITH_SKCF
+    methods.push_back("skcf");
+#endif
+#ifdef WITH_NCC
+    methods.push_back("ncc");
+#endif
+#ifdef WITH_KCF
+    methods.push_back("kcf");
+#endif
+#ifdef WITH_KCF2
+    methods.push_back("kcf2");
+#endif
+#ifdef WITH_STRUCK
+    methods.push_back("struck");
+#endif
+#ifdef WITH_OPENTLD
+    methods.push_back("opentld");
+#endif
+}
+bool TrackerFactory::isThreadSafe(const string &method)
+{
+    //opentld keeps global state, struck seeds and draws from the rand() stream
+    return method != "opentld" && method != "struck";
+}
+void TrackerFactory::datasetSequences(const string &dataset, vector<string> &sequences)
+{
+    sequences.clear();
+    string base = constructSequenceFolder(SEQ_BASE_FILE, "");
+    
+    vector<string> datasets;
+    if (dataset.empty())
+    {
+        if (isFolderSequence(base))
+            viva::Files::listdir(base, datasets, false);
+    }
+    else
+        datasets.push_back(dataset);
+    
+    for (size_t i = 0; i < datasets.size(); ++i)
+    {
+        std::ifstream infile(base + datasets[i] + viva::Files::PATH_SEPARATOR + "list.txt");
+        std::string line;
+        while (std::getline(infile, line))
+        {
+            std::istringstream iss(line);
+            string name;
+            if (iss >> name)
+                sequences.push_back(datasets[i] + viva::Files::PATH_SEPARATOR + name);
+        }
+    }
+}
+Ptr<DatasetManifest> TrackerFactory::manifest()
+{
+    static std::mutex lock;
+    static Ptr<DatasetManifest> instance;
+    
+    std::lock_guard<std::mutex> guard(lock);
+    if (!instance)
+    {
+        // without a sequences folder configured there are no datasets to index
+        if (viva::Files::isFile(SEQ_BASE_FILE))
+            instance = DatasetManifest::open(constructSequenceFolder(SEQ_BASE_FILE, ""));
+        else
+            instance = new DatasetManifest();
+    }
+    return instance;
+}
+const SequenceEntry *TrackerFactory::findDatasetSequence(const string &sequence)
+{
+    //only the dataset/sequence form needs the manifest, other names must not open it
+    if (isVideoFile(sequence) || isWebFile(sequence) || isStringSequence(sequence) ||
+        isCameraID(sequence) || isFolderSequence(sequence))
+        return NULL;
+    return manifest()->find(sequence);
+}
 void TrackerFactory::loadGroundTruth(const string &sequence, vector<vector<Point2f> > &groundTruth)
 {
     GroundTruth::parse(sequence, groundTruth);
@@ -362,6 +720,17 @@ void TrackerFactory::loadGroundTruth(const string &sequence, vector<vector<Point
 void TrackerFactory::findGroundTruth(const string &sequence, vector<vector<Point2f> > &groundTruth)
 {
     string basename;
+    SyntheticConfig config;
+    if (SyntheticConfig::parse(sequence, config))
+    {
+        SyntheticInput(config).getGroundTruth(groundTruth);
+        return;
+    }
+    if (isPackedSequence(sequence))
+    {
+        PackedInput(sequence).getGroundTruth(groundTruth);
+        return;
+    }
     if (isVideoFile(sequence))
     {
         viva::Files::getBasename(sequence, basename);
@@ -386,6 +755,12 @@ void TrackerFactory::findGroundTruth(const string &sequence, vector<vector<Point
         else
             basename = sequence;
     }
+    const SequenceEntry *entry = findDatasetSequence(sequence);
+    if (entry != NULL)
+    {
+        GroundTruth::parse(entry->groundTruth, groundTruth);
+        return;
+    }
     string path = constructSequenceFolder(SEQ_BASE_FILE, sequence);
     if (isFolderSequence(path))
     {
@@ -38,6 +38,8 @@
 
 #include "precomp.h"
 #include "tracking_process.h"
+#include "manifest.h"
+#include <mutex>
 
 
 #ifdef WITH_SKCF
@@ -82,14 +84,18 @@ private:
     static bool isWebFile(const string &sequence);
     static bool isStringSequence(const string &sequence);
     static bool isFolderSequence(const string &sequence);
+    static bool isPackedSequence(const string &sequence);
     static string constructSequenceFolder(const string &file, const string &sequence);
+    static String trackerKeys(const string &method);
 
     
 public:
 
     /**
      * Giving a string it determines what kind of sequence could be loaded and 
-     * returns an object follwing the vivalib::Input interface
+     * returns an object follwing the vivalib::Input interface.
+     * synthetic[:seed[:WIDTHxHEIGHT[:frames[:objects]]]] creates a procedural sequence (see viva::SyntheticInput)
+     * and .vpk files are read as packed sequences (see viva::PackedInput)
      */
     static Ptr<Input> createInput(const string &sequence);
     /**
@@ -104,6 +110,17 @@ public:
      * see project's wiki for more details how to create your own tracker
      */
     static Ptr<Tracker> createTracker(const string &method, const int argc, const char * argv[]);
+    /**
+     * Returns the options of a tracker, as createTracker parses them from the command line arguments,
+     * in a canonical "name=value;" form. Omitted options take their default value.
+     */
+    static string trackerOptions(const string &method, const int argc, const char * argv[]);
+    /**
+     * Returns an identifier of the current build of a tracker library. It changes whenever
+     * the sources of the tracker, vivalib or trackerlib or the compile flags change
+     * (computed at build time, see buildid.txt).
+     */
+    static string buildIdentifier(const string &method);
     /**
      * find the groundtruth file from a filename if available into a 2D list of points.
      * This method will look for a groundtruth.txt file in the same folder of the sequence
@@ -113,6 +130,32 @@ public:
      * loads the groundtruth file from a filename if available into a 2D list of points.
      */
     static void loadGroundTruth(const string &sequence, vector<vector<Point2f> > &groundTruth);
+    /**
+     * Returns the identifiers of the trackers compiled in the project (WITH_* options).
+     */
+    static void availableTrackers(vector<string> &methods);
+    /**
+     * Returns false for trackers keeping process-global state (opentld, and
+     * struck, which seeds and draws from the shared rand() stream), whose
+     * instances can not run concurrently or would not be reproducible.
+     */
+    static bool isThreadSafe(const string &method);
+    /**
+     * Returns the sequences listed in the list.txt file of a dataset inside the sequences folder.
+     * Each sequence is returned as dataset/sequence so it can be passed to createInput and findGroundTruth.
+     * If dataset is empty every dataset found in the sequences folder is listed.
+     */
+    static void datasetSequences(const string &dataset, vector<string> &sequences);
+    /**
+     * Returns the manifest of the sequences folder. It is opened (or built) on the first call
+     * and shared afterwards, see DatasetManifest.
+     */
+    static Ptr<DatasetManifest> manifest();
+    /**
+     * Looks a dataset/sequence name up in the manifest. Video files, URLs, camera IDs,
+     * and existing paths never open the manifest and return NULL.
+     */
+    static const SequenceEntry *findDatasetSequence(const string &sequence);
 
 };
 
@@ -147,6 +190,29 @@ public:
      */
     static void  parse(const string &file, vector<vector<Point2f> > &gt);
 
+    /**
+     *  parses and loads a ground-truth file into a flat list of corners, 4 per frame.
+     *  Frames without a valid annotation have NaN corners.
+     *  The binary sidecar (see binaryFile) is used instead of the text file when it was created
+     *  from a file of the same size and modification time.
+     * @param file: filename of the file containing the ground-truth annotations
+     * @param corners: outputs the 4 corners of every frame contiguously
+     * @return false if the file could not be read
+     */
+    static bool  parse(const string &file, vector<Point2f> &corners);
+
+    /**
+     * returns the filename of the binary sidecar of a ground-truth file (groundtruth.txt -> groundtruth.gtb)
+     */
+    static string binaryFile(const string &file);
+
+    /**
+     * writes the binary sidecar of a ground-truth file. The sidecar stores the flat list of
+     * corners and is loaded with a single read.
+     * @return false if the ground-truth could not be parsed or the sidecar could not be written
+     */
+    static bool createBinary(const string &file);
+
 
     /**
      * creates a ground-truth file from a 2D list of points.
@@ -0,0 +1,293 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "manifest.h"
+#include "factories.h"
+#include <cctype>
+
+const string DatasetManifest::MANIFEST_FILE = "manifest.txt";
+static const string MANIFEST_VERSION = "manifest 2";
+
+string DatasetManifest::normalize(const string &sequence)
+{
+    string name(sequence);
+    std::replace(name.begin(), name.end(), '\\', '/');
+    for (size_t i = name.find("//", 1); i != string::npos; i = name.find("//", i))
+        name.erase(i, 1);
+    while (name.size() > 1 && name.back() == '/')
+        name.erase(name.size() - 1);
+    return name;
+}
+
+/*
+ * Percent-encodes the characters that would split a field of the manifest
+ */
+string DatasetManifest::escape(const string &value)
+{
+    static const char HEX[] = "0123456789ABCDEF";
+    string out;
+    out.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        unsigned char c = (unsigned char)value[i];
+        if (c <= ' ' || c == '%' || c == 127)
+        {
+            out += '%';
+            out += HEX[c >> 4];
+            out += HEX[c & 15];
+        }
+        else
+            out += (char)c;
+    }
+    return out;
+}
+
+string DatasetManifest::unescape(const string &value)
+{
+    string out;
+    out.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        if (value[i] == '%' && i + 2 < value.size() && std::isxdigit((unsigned char)value[i + 1]) &&
+            std::isxdigit((unsigned char)value[i + 2]))
+        {
+            out += (char)std::stoi(value.substr(i + 1, 2), NULL, 16);
+            i += 2;
+        }
+        else
+            out += value[i];
+    }
+    return out;
+}
+
+/*
+ * Size and modification time of a path as a single field, - if it does not exist
+ */
+string DatasetManifest::stamp(const string &path)
+{
+    int64_t size, mtime;
+    if (!Files::stamp(path, size, mtime))
+        return "-";
+    std::ostringstream ss;
+    ss << size << ":" << mtime;
+    return ss.str();
+}
+
+void DatasetManifest::addStamp(const string &path)
+{
+    _stamps.push_back(make_pair(path, stamp(_root + path)));
+}
+
+void DatasetManifest::reindex()
+{
+    _index.clear();
+    for (size_t i = 0; i < _sequences.size(); ++i)
+        _index[normalize(_sequences[i].name)] = i;
+}
+
+void DatasetManifest::add(const string &name, const string &folder)
+{
+    SequenceEntry entry;
+    entry.name = name;
+    Files::listImages(folder, entry.frames);
+    if (entry.frames.empty())
+    {
+        addStamp(name);
+        return;
+    }
+    
+    Mat first = imread(entry.frames[0]);
+    entry.resolution = first.size();
+    addStamp(entry.frames[0].substr(_root.size()));
+    
+    string gt = folder + Files::PATH_SEPARATOR + "groundtruth.txt";
+    addStamp(gt.substr(_root.size()));
+    if (Files::isFile(gt))
+    {
+        entry.groundTruth = gt;
+        GroundTruth::createBinary(gt);
+    }
+    //stamped after writing the sidecar, which modifies the folder
+    addStamp(name);
+    _sequences.push_back(entry);
+}
+
+void DatasetManifest::build(const string &root)
+{
+    _root = root;
+    _sequences.clear();
+    _stamps.clear();
+    
+    //the root itself detects datasets added or removed
+    addStamp(".");
+    vector<string> datasets;
+    if (Files::isDir(root))
+        Files::listdir(root, datasets, false);
+    
+    for (size_t d = 0; d < datasets.size(); ++d)
+    {
+        string folder = root + datasets[d];
+        if (!Files::isDir(folder))
+            continue;
+        
+        //the dataset folder and its list detect sequences added or removed
+        addStamp(datasets[d]);
+        addStamp(datasets[d] + Files::PATH_SEPARATOR + "list.txt");
+        vector<string> names;
+        std::ifstream list((folder + Files::PATH_SEPARATOR + "list.txt").c_str());
+        string line;
+        while (std::getline(list, line))
+        {
+            std::istringstream iss(line);
+            string name;
+            if (iss >> name)
+                names.push_back(name);
+        }
+        if (names.empty())
+        {
+            vector<string> children;
+            Files::listdir(folder, children, false);
+            for (size_t c = 0; c < children.size(); ++c)
+                if (Files::isDir(folder + Files::PATH_SEPARATOR + children[c]))
+                    names.push_back(children[c]);
+        }
+        
+        for (size_t s = 0; s < names.size(); ++s)
+            add(datasets[d] + Files::PATH_SEPARATOR + names[s], folder + Files::PATH_SEPARATOR + names[s]);
+    }
+    reindex();
+}
+
+bool DatasetManifest::save(const string &file) const
+{
+    std::ofstream outfile(file.c_str());
+    if (!outfile.is_open())
+        return false;
+    
+    outfile << MANIFEST_VERSION << endl;
+    for (size_t i = 0; i < _stamps.size(); ++i)
+        outfile << "stamp " << escape(_stamps[i].first) << " " << _stamps[i].second << "\n";
+    for (size_t i = 0; i < _sequences.size(); ++i)
+    {
+        const SequenceEntry &entry = _sequences[i];
+        outfile << "sequence " << escape(entry.name) << " " << entry.frames.size() << " "
+                << entry.resolution.width << " " << entry.resolution.height << " "
+                << (entry.groundTruth.empty() ? "-" : escape(entry.groundTruth.substr(_root.size()))) << endl;
+        for (size_t k = 0; k < entry.frames.size(); ++k)
+            outfile << escape(entry.frames[k].substr(_root.size())) << "\n";
+    }
+    return outfile.good();
+}
+
+bool DatasetManifest::load(const string &root, const string &file)
+{
+    _root = root;
+    _sequences.clear();
+    _stamps.clear();
+    
+    std::ifstream infile(file.c_str());
+    string line;
+    if (!std::getline(infile, line) || line != MANIFEST_VERSION)
+        return false;
+    
+    while (std::getline(infile, line))
+    {
+        std::istringstream iss(line);
+        string tag, name, gt;
+        size_t count = 0;
+        SequenceEntry entry;
+        if (!(iss >> tag >> name))
+            return false;
+        if (tag == "stamp")
+        {
+            string value;
+            if (!(iss >> value))
+                return false;
+            _stamps.push_back(make_pair(unescape(name), value));
+            continue;
+        }
+        if (!(iss >> count >> entry.resolution.width >> entry.resolution.height >> gt) ||
+            tag != "sequence")
+            return false;
+        
+        entry.name        = unescape(name);
+        entry.groundTruth = (gt == "-") ? "" : root + unescape(gt);
+        entry.frames.resize(count);
+        for (size_t k = 0; k < count; ++k)
+        {
+            if (!std::getline(infile, line))
+                return false;
+            entry.frames[k] = root + unescape(line);
+        }
+        _sequences.push_back(entry);
+    }
+    reindex();
+    return true;
+}
+
+Ptr<DatasetManifest> DatasetManifest::open(const string &root)
+{
+    Ptr<DatasetManifest> manifest(new DatasetManifest());
+    string file = root + MANIFEST_FILE;
+    
+    if (!manifest->load(root, file) || !manifest->upToDate())
+    {
+        //created before the root is stamped, rewriting it later does not modify the root
+        std::ofstream(file.c_str(), std::ios::app).close();
+        manifest->build(root);
+        manifest->save(file);
+    }
+    return manifest;
+}
+
+bool DatasetManifest::upToDate() const
+{
+    if (_stamps.empty())
+        return false;
+    for (size_t i = 0; i < _stamps.size(); ++i)
+        if (stamp(_root + _stamps[i].first) != _stamps[i].second)
+            return false;
+    return true;
+}
+
+const SequenceEntry *DatasetManifest::find(const string &sequence) const
+{
+    string name = normalize(sequence);
+    string root = normalize(_root) + "/";
+    if (name.compare(0, root.size(), root) == 0)
+        name = name.substr(root.size());
+    
+    unordered_map<string, size_t>::const_iterator it = _index.find(name);
+    return (it == _index.end()) ? NULL : &_sequences[it->second];
+}
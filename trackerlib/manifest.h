@@ -0,0 +1,128 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __trackers__manifest__
+#define __trackers__manifest__
+
+#include "viva.h"
+#include <unordered_map>
+#include <fstream>
+
+
+using namespace viva;
+using namespace std;
+using namespace cv;
+
+/**
+ * SequenceEntry struct
+ * Description of a sequence stored in the dataset manifest.
+ */
+struct SequenceEntry
+{
+    string name;            /**< dataset/sequence identifier*/
+    vector<string> frames;  /**< sorted list of the frame images (full paths)*/
+    Size resolution;        /**< resolution of the first frame*/
+    string groundTruth;     /**< ground-truth file (full path), empty if not available*/
+};
+
+/**
+ * DatasetManifest class
+ * Index of the sequences available inside a datasets root folder (the sequences folder
+ * where CHECK_DATASETS unpacks the datasets). The folders are scanned once and the
+ * result is stored in a manifest file inside the root, so following runs resolve
+ * sequences with a single lookup and without listing directories.
+ *
+ * The manifest stores the size and modification time of the root, of every dataset
+ * folder and list.txt, and of every sequence folder, first frame and ground-truth file.
+ * It is rebuilt when any of them changes, e.g., after a new dataset is unpacked, a sequence
+ * is added to a dataset or its frames or ground-truth are replaced. Sequences are the folders
+ * listed in each dataset's list.txt or, if the dataset has none, its sub-folders containing images.
+ */
+class DatasetManifest
+{
+private:
+    string _root;
+    vector<SequenceEntry> _sequences;
+    unordered_map<string, size_t> _index;
+    vector<pair<string, string> > _stamps;
+
+    static string normalize(const string &sequence);
+    static string escape(const string &value);
+    static string unescape(const string &value);
+    static string stamp(const string &path);
+    void add(const string &name, const string &folder);
+    void addStamp(const string &path);
+    void reindex();
+
+public:
+    static const string MANIFEST_FILE;
+
+    DatasetManifest(): _root(), _sequences(), _index(), _stamps() {}
+
+    /**
+     * Loads the manifest of the root folder, building and saving it if it is missing or outdated.
+     */
+    static Ptr<DatasetManifest> open(const string &root);
+
+    /**
+     * Scans the root folder and indexes every sequence found.
+     * Writes the binary ground-truth sidecars (see GroundTruth::createBinary) of the sequences.
+     */
+    void build(const string &root);
+    /**
+     * Loads a manifest file. Paths are relative to the root folder.
+     */
+    bool load(const string &root, const string &file);
+    /**
+     * Checks the stamps of the folders and files the manifest was built from.
+     * @return false if any of them was modified, added or removed since the build
+     */
+    bool upToDate() const;
+    /**
+     * Saves the manifest into a file. Paths are stored relative to the root folder,
+     * with spaces and control characters escaped.
+     */
+    bool save(const string &file) const;
+
+    /**
+     * Finds a sequence by its dataset/sequence identifier or by its folder inside the root.
+     * @return NULL if the sequence is not indexed
+     */
+    const SequenceEntry *find(const string &sequence) const;
+
+    const vector<SequenceEntry> &sequences() const { return _sequences; }
+    const string &root() const { return _root; }
+};
+
+#endif /* defined(__trackers__manifest__) */
@@ -0,0 +1,226 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "result_cache.h"
+#include "factories.h"
+#include <iomanip>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
+#ifdef _WIN32
+    #include <process.h>
+    #define getpid _getpid
+#else
+    #include <unistd.h>
+#endif
+
+ResultCache::ResultCache(const string &folder):
+_folder(folder)
+{
+    if (!_folder.empty() && _folder.back() != Files::PATH_SEPARATOR.front())
+        _folder += Files::PATH_SEPARATOR;
+    Files::makeDir(_folder);
+}
+
+uint64_t ResultCache::hash(const void *data, size_t size, uint64_t seed)
+{
+    //word-wise multiply/xor-shift mixing, tail bytes folded with FNV-1a
+    const uint64_t M = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = seed ^ (size * M);
+    const unsigned char *p = (const unsigned char *)data;
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; ++i, p += 8)
+    {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        w *= M;
+        w ^= w >> 29;
+        h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+    }
+    for (size_t i = words * 8; i < size; ++i, ++p)
+        h = (h ^ *p) * 0x100000001B3ULL;
+    h ^= h >> 31;
+    return h;
+}
+
+uint64_t ResultCache::sequenceHash(const string &sequence)
+{
+    uint64_t h = 0;
+    
+    SyntheticConfig config;
+    if (SyntheticConfig::parse(sequence, config))
+        return hash(sequence.data(), sequence.size());
+    
+    const SequenceEntry *entry = TrackerFactory::findDatasetSequence(sequence);
+    if (entry != NULL)
+    {
+        for (size_t i = 0; i < entry->frames.size(); ++i)
+        {
+            MappedFile file(entry->frames[i]);
+            h = hash(file.data(), file.size(), h);
+        }
+        MappedFile gt(entry->groundTruth);
+        return hash(gt.data(), gt.size(), h);
+    }
+    
+    string extension;
+    Files::getExtension(sequence, extension);
+    if (extension == "vpk" && Files::isFile(sequence))
+    {
+        MappedFile file(sequence);
+        return hash(file.data(), file.size(), h);
+    }
+    
+    Ptr<Input> input = TrackerFactory::createInput(sequence);
+    Mat frame;
+    while (input && input->getFrame(frame))
+    {
+        if (!frame.isContinuous())
+            frame = frame.clone();
+        h = hash(frame.data, frame.total() * frame.elemSize(), h);
+    }
+    vector<vector<Point2f> > gt;
+    TrackerFactory::findGroundTruth(sequence, gt);
+    for (size_t i = 0; i < gt.size(); ++i)
+        h = hash(gt[i].data(), gt[i].size() * sizeof(Point2f), h);
+    return h;
+}
+
+string ResultCache::trackerKey(const string &method, const int argc, const char * argv[])
+{
+    ostringstream key;
+    key << method << "|" << TrackerFactory::trackerOptions(method, argc, argv)
+        << "|" << TrackerFactory::buildIdentifier(method) << "|" << CV_VERSION;
+    return key.str();
+}
+
+string ResultCache::key(const string &tracker, const SupervisedConfig &config, uint64_t sequence)
+{
+    ostringstream key;
+    key << tracker << "|" << config.skipFrames << "," << config.burnIn << "," << config.failureOverlap
+        << "|" << std::hex << std::setw(16) << std::setfill('0') << sequence;
+    return key.str();
+}
+
+string ResultCache::filename(const string &key) const
+{
+    ostringstream name;
+    name << _folder << std::hex << std::setw(16) << std::setfill('0') << hash(key.data(), key.size()) << ".txt";
+    return name.str();
+}
+
+bool ResultCache::load(const string &key, SupervisedResult &result) const
+{
+    std::ifstream infile(filename(key).c_str());
+    string line;
+    //the key is stored in the first line to discard hash collisions
+    if (!std::getline(infile, line) || line != key)
+        return false;
+    
+    SupervisedResult stored;
+    size_t segments = 0, areas = 0;
+    infile >> stored.frames >> stored.failures >> stored.validFrames >> stored.accuracy
+           >> stored.initTime >> stored.trackTime >> stored.trackedFrames >> segments;
+    stored.segments.resize(segments);
+    for (size_t i = 0; i < segments && infile; ++i)
+    {
+        size_t count = 0;
+        infile >> stored.segments[i].failed >> count;
+        stored.segments[i].overlaps.resize(count);
+        for (size_t k = 0; k < count; ++k)
+            infile >> stored.segments[i].overlaps[k];
+    }
+    infile >> areas;
+    stored.trajectory.resize(areas);
+    for (size_t i = 0; i < areas && infile; ++i)
+    {
+        size_t count = 0;
+        infile >> count;
+        stored.trajectory[i].resize(count);
+        for (size_t k = 0; k < count; ++k)
+            infile >> stored.trajectory[i][k].x >> stored.trajectory[i][k].y;
+    }
+    if (!infile)
+        return false;
+    
+    stored.sequence = result.sequence;
+    stored.method   = result.method;
+    result = stored;
+    return true;
+}
+
+bool ResultCache::store(const string &key, const SupervisedResult &result) const
+{
+    //every writer has its own temporary file, the same key can be evaluated concurrently
+    static std::atomic<unsigned> writers(0);
+    string name = filename(key);
+    ostringstream tmpName;
+    tmpName << name << "." << getpid() << "." << writers++ << ".tmp";
+    string tmp  = tmpName.str();
+    {
+        std::ofstream outfile(tmp.c_str());
+        outfile << key << endl << std::setprecision(17)
+                << result.frames << " " << result.failures << " " << result.validFrames << " "
+                << result.accuracy << " " << result.initTime << " " << result.trackTime << " "
+                << result.trackedFrames << endl << result.segments.size() << endl;
+        outfile << std::setprecision(9);
+        for (size_t i = 0; i < result.segments.size(); ++i)
+        {
+            const SupervisedSegment &segment = result.segments[i];
+            outfile << segment.failed << " " << segment.overlaps.size();
+            for (size_t k = 0; k < segment.overlaps.size(); ++k)
+                outfile << " " << segment.overlaps[k];
+            outfile << endl;
+        }
+        outfile << result.trajectory.size() << endl;
+        for (size_t i = 0; i < result.trajectory.size(); ++i)
+        {
+            outfile << result.trajectory[i].size();
+            for (size_t k = 0; k < result.trajectory[i].size(); ++k)
+                outfile << " " << result.trajectory[i][k].x << " " << result.trajectory[i][k].y;
+            outfile << endl;
+        }
+        if (!outfile.good())
+        {
+            outfile.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    //results written by concurrent evaluations replace each other atomically
+#ifdef _WIN32
+    std::remove(name.c_str());
+#endif
+    return std::rename(tmp.c_str(), name.c_str()) == 0;
+}
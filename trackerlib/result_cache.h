@@ -0,0 +1,99 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __trackers__result_cache__
+#define __trackers__result_cache__
+
+#include "evaluation.h"
+#include <cstdint>
+
+
+using namespace viva;
+using namespace std;
+using namespace cv;
+
+/**
+ * ResultCache class
+ * Stores the results of supervised evaluations in a folder, one file per
+ * combination of tracker, tracker options, tracker build, evaluation parameters
+ * and sequence content. A stored result is returned instead of running the
+ * tracker again while none of those change.
+ */
+class ResultCache
+{
+private:
+    string _folder;
+    
+    string filename(const string &key) const;
+    
+public:
+    /**
+     * @param folder: folder where the results are stored. It is created if needed
+     */
+    ResultCache(const string &folder);
+    
+    /**
+     * 64 bits hash of a memory block
+     */
+    static uint64_t hash(const void *data, size_t size, uint64_t seed = 0);
+    
+    /**
+     * Hash of the content of a sequence and its ground-truth. Indexed and packed sequences
+     * hash their files without decoding them, other inputs hash the decoded frames.
+     */
+    static uint64_t sequenceHash(const string &sequence);
+    
+    /**
+     * Key identifying a tracker configuration: method, parsed options and build identifier
+     * (see TrackerFactory::trackerOptions and TrackerFactory::buildIdentifier).
+     */
+    static string trackerKey(const string &method, const int argc, const char * argv[]);
+    
+    /**
+     * Complete key of a supervised evaluation of a tracker configuration over a sequence
+     */
+    static string key(const string &tracker, const SupervisedConfig &config, uint64_t sequence);
+    
+    /**
+     * Loads a stored result. The sequence and method labels are not modified.
+     * @return false if there is no result stored for the key
+     */
+    bool load(const string &key, SupervisedResult &result) const;
+    /**
+     * Stores a result for the key
+     */
+    bool store(const string &key, const SupervisedResult &result) const;
+};
+
+#endif /* defined(__trackers__result_cache__) */
@@ -0,0 +1,397 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "sharded_evaluation.h"
+#include "factories.h"
+#include <deque>
+#include <iomanip>
+
+#ifndef _WIN32
+    #include <unistd.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <sys/wait.h>
+#endif
+
+/*
+ * Input forwarding the frames [begin, end) of another input.
+ * The input is moved to begin with seek, frames before it are only decoded
+ * when the input can not seek.
+ */
+class RangeInput: public Input
+{
+    Ptr<Input> _input;
+    size_t _frameN;
+    size_t _end;
+    
+public:
+    RangeInput(const Ptr<Input> &input, size_t begin, size_t end):
+        Input(), _input(input), _frameN(0), _end(end)
+    {
+        if (_input && _input->seek(begin))
+        {
+            _frameN = begin;
+            return;
+        }
+        Mat frame;
+        while (_input && _frameN < begin && _input->getFrame(frame))
+            _frameN++;
+    }
+    
+    bool getFrame(Mat &frame)
+    {
+        if (!_input || _frameN >= _end || !_input->getFrame(frame))
+            return false;
+        _frameN++;
+        _orgSize = _size = frame.size();
+        return true;
+    }
+};
+
+bool ShardedEvaluation::run(const string &sequence,
+                            const Ptr<Tracker> &tracker,
+                            const Shard &shard,
+                            vector<vector<Point2f> > &trajectory,
+                            RunResult &result)
+{
+    vector<vector<Point2f> > gt;
+    TrackerFactory::findGroundTruth(sequence, gt);
+    if (shard.begin >= gt.size())
+        return false;
+    gt.erase(gt.begin(), gt.begin() + shard.begin);
+    
+    Ptr<Input> input = new RangeInput(TrackerFactory::createInput(sequence), shard.begin, shard.end);
+    return DatasetRunner::run(input, gt, tracker, trajectory, result);
+}
+
+#ifndef _WIN32
+/*
+ * Message of a worker: "<bytes>\n" followed by
+ * "<shard> <frames> <initTime> <trackTime> <trackedFrames>\n" and one line per tracked area
+ */
+static string encode(size_t index, const RunResult &result, const vector<vector<Point2f> > &trajectory)
+{
+    ostringstream payload;
+    payload << std::setprecision(17) << index << " " << result.frames << " " << result.initTime << " "
+            << result.trackTime << " " << result.trackedFrames << "\n" << std::setprecision(9);
+    for (size_t i = 0; i < trajectory.size(); ++i)
+    {
+        payload << trajectory[i].size();
+        for (size_t k = 0; k < trajectory[i].size(); ++k)
+            payload << " " << trajectory[i][k].x << " " << trajectory[i][k].y;
+        payload << "\n";
+    }
+    ostringstream message;
+    message << payload.str().size() << "\n" << payload.str();
+    return message.str();
+}
+
+static void decode(const string &payload, size_t &index, RunResult &result, vector<vector<Point2f> > &trajectory)
+{
+    std::istringstream iss(payload);
+    iss >> index >> result.frames >> result.initTime >> result.trackTime >> result.trackedFrames;
+    trajectory.assign(result.frames, vector<Point2f>());
+    for (size_t i = 0; i < result.frames; ++i)
+    {
+        size_t count = 0;
+        iss >> count;
+        trajectory[i].resize(count);
+        for (size_t k = 0; k < count; ++k)
+            iss >> trajectory[i][k].x >> trajectory[i][k].y;
+    }
+}
+
+static bool writeAll(int fd, const string &data)
+{
+    for (size_t written = 0; written < data.size();)
+    {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n <= 0)
+            return false;
+        written += n;
+    }
+    return true;
+}
+
+struct WorkerProcess
+{
+    pid_t pid;
+    int tasks;      /**< coordinator -> worker, shard indices*/
+    int results;    /**< worker -> coordinator, encoded results*/
+    long shard;     /**< shard being processed, -1 if idle*/
+    string buffer;  /**< bytes received and not parsed yet*/
+};
+#endif
+
+void ShardedEvaluation::run(const vector<string> &sequences,
+                            const vector<string> &methods,
+                            const DatasetRunner::TrackerCreator &creator,
+                            const string &folder,
+                            vector<RunResult> &results)
+{
+    _crashes = 0;
+    results.clear();
+    results.resize(sequences.size() * methods.size());
+    
+    //shards of every (sequence, method) pair in frame order
+    vector<Shard> shards;
+    for (size_t s = 0; s < sequences.size(); ++s)
+    {
+        vector<vector<Point2f> > gt;
+        TrackerFactory::findGroundTruth(sequences[s], gt);
+        size_t step = (_shardFrames > 0) ? _shardFrames : std::max((size_t)1, gt.size());
+        for (size_t m = 0; m < methods.size(); ++m)
+        {
+            RunResult &result = results[s * methods.size() + m];
+            result.sequence = sequences[s];
+            result.method   = methods[m];
+            for (size_t begin = 0; begin < gt.size(); begin += step)
+            {
+                Shard shard = { s, m, begin, std::min(gt.size(), begin + step) };
+                shards.push_back(shard);
+            }
+        }
+    }
+    
+    vector<vector<vector<Point2f> > > trajectories(shards.size());
+    vector<RunResult> partial(shards.size());
+    
+#ifdef _WIN32
+    for (size_t i = 0; i < shards.size(); ++i)
+        run(sequences[shards[i].sequence], creator(methods[shards[i].method]), shards[i], trajectories[i], partial[i]);
+#else
+    size_t workers = (_workers > 0) ? _workers : ThreadBudget::share();
+    ThreadBudget::Lease lease(std::max((size_t)1, std::min(workers, shards.size())));
+    workers = lease.threads();
+    
+    signal(SIGPIPE, SIG_IGN);
+    vector<WorkerProcess> pool(workers);
+    std::deque<size_t> pending;
+    vector<int> attempts(shards.size(), 0);
+    for (size_t i = 0; i < shards.size(); ++i)
+        pending.push_back(i);
+    
+    auto spawn = [&](WorkerProcess &worker)
+    {
+        int tasks[2], output[2];
+        worker.pid = -1;
+        worker.shard = -1;
+        worker.buffer.clear();
+        if (pipe(tasks) != 0)
+            return;
+        if (pipe(output) != 0)
+        {
+            close(tasks[0]);
+            close(tasks[1]);
+            return;
+        }
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            //worker: the pipes of the other workers are not used
+            for (size_t w = 0; w < pool.size(); ++w)
+            {
+                if (&pool[w] != &worker && pool[w].pid > 0)
+                {
+                    close(pool[w].tasks);
+                    close(pool[w].results);
+                }
+            }
+            close(tasks[1]);
+            close(output[0]);
+            ThreadBudget::detach(lease.share());
+            
+            string line;
+            char c;
+            while (read(tasks[0], &c, 1) == 1)
+            {
+                if (c != '\n')
+                {
+                    line += c;
+                    continue;
+                }
+                size_t index = strtoul(line.c_str(), NULL, 10);
+                line.clear();
+                
+                RunResult result;
+                vector<vector<Point2f> > trajectory;
+                const Shard &shard = shards[index];
+                run(sequences[shard.sequence], creator(methods[shard.method]), shard, trajectory, result);
+                if (!writeAll(output[1], encode(index, result, trajectory)))
+                    break;
+            }
+            _exit(0);
+        }
+        close(tasks[0]);
+        close(output[1]);
+        if (pid < 0)
+        {
+            close(tasks[1]);
+            close(output[0]);
+            return;
+        }
+        worker.pid     = pid;
+        worker.tasks   = tasks[1];
+        worker.results = output[0];
+    };
+    
+    auto retire = [&](WorkerProcess &worker)
+    {
+        close(worker.tasks);
+        close(worker.results);
+        int status = 0;
+        waitpid(worker.pid, &status, 0);
+        worker.pid = -1;
+    };
+    
+    size_t completed = 0;
+    auto assign = [&](WorkerProcess &worker)
+    {
+        while (worker.pid > 0 && worker.shard < 0 && !pending.empty())
+        {
+            size_t index = pending.front();
+            pending.pop_front();
+            ostringstream task;
+            task << index << "\n";
+            worker.shard = (long)index;
+            if (!writeAll(worker.tasks, task.str()))
+                return;
+        }
+    };
+    
+    for (size_t w = 0; w < pool.size(); ++w)
+    {
+        pool[w].pid = -1;
+        spawn(pool[w]);
+        assign(pool[w]);
+    }
+    
+    vector<char> chunk(1 << 16);
+    while (completed < shards.size())
+    {
+        vector<pollfd> fds;
+        vector<size_t> owners;
+        for (size_t w = 0; w < pool.size(); ++w)
+        {
+            if (pool[w].pid <= 0)
+                continue;
+            pollfd fd = { pool[w].results, POLLIN, 0 };
+            fds.push_back(fd);
+            owners.push_back(w);
+        }
+        if (fds.empty())
+        {
+            //no worker could be started: the remaining shards are lost
+            completed = shards.size();
+            break;
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0)
+            continue;
+        
+        for (size_t f = 0; f < fds.size(); ++f)
+        {
+            if (fds[f].revents == 0)
+                continue;
+            WorkerProcess &worker = pool[owners[f]];
+            ssize_t n = read(worker.results, chunk.data(), chunk.size());
+            if (n > 0)
+            {
+                worker.buffer.append(chunk.data(), n);
+                size_t newline;
+                while ((newline = worker.buffer.find('\n')) != string::npos)
+                {
+                    size_t bytes = strtoul(worker.buffer.c_str(), NULL, 10);
+                    if (worker.buffer.size() < newline + 1 + bytes)
+                        break;
+                    size_t index = 0;
+                    RunResult result;
+                    vector<vector<Point2f> > trajectory;
+                    decode(worker.buffer.substr(newline + 1, bytes), index, result, trajectory);
+                    worker.buffer.erase(0, newline + 1 + bytes);
+                    if (index < shards.size())
+                    {
+                        partial[index] = result;
+                        trajectories[index].swap(trajectory);
+                    }
+                    worker.shard = -1;
+                    completed++;
+                }
+                assign(worker);
+                continue;
+            }
+            
+            //the worker died: retry its shard once and restart it
+            _crashes++;
+            if (worker.shard >= 0)
+            {
+                if (++attempts[worker.shard] < 2)
+                    pending.push_front(worker.shard);
+                else
+                    completed++;
+            }
+            retire(worker);
+            if (!pending.empty())
+            {
+                spawn(worker);
+                assign(worker);
+            }
+        }
+    }
+    
+    for (size_t w = 0; w < pool.size(); ++w)
+        if (pool[w].pid > 0)
+            retire(pool[w]);
+#endif
+    
+    //merge the shards of each pair in frame order
+    vector<vector<vector<Point2f> > > merged(results.size());
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        size_t pair = shards[i].sequence * methods.size() + shards[i].method;
+        RunResult &result = results[pair];
+        result.initTime      += partial[i].initTime;
+        result.trackTime     += partial[i].trackTime;
+        result.trackedFrames += partial[i].trackedFrames;
+        
+        //frames of a failed shard are reported without tracked area
+        trajectories[i].resize(shards[i].end - shards[i].begin);
+        merged[pair].insert(merged[pair].end(), trajectories[i].begin(), trajectories[i].end());
+        result.frames = merged[pair].size();
+    }
+    
+    if (!folder.empty())
+        for (size_t i = 0; i < results.size(); ++i)
+            if (results[i].frames > 0)
+                DatasetRunner::write(folder, merged[i], results[i]);
+}
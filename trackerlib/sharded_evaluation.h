@@ -0,0 +1,112 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __trackers__sharded_evaluation__
+#define __trackers__sharded_evaluation__
+
+#include "dataset_runner.h"
+
+
+using namespace viva;
+using namespace std;
+using namespace cv;
+
+/**
+ * Shard struct
+ * Frames [begin, end) of a sequence tracked by one method. The tracker is
+ * initialized from the ground-truth of the first annotated frame of the range.
+ */
+struct Shard
+{
+    size_t sequence;    /**< index of the sequence*/
+    size_t method;      /**< index of the method*/
+    size_t begin;       /**< first frame*/
+    size_t end;         /**< one past the last frame*/
+};
+
+/**
+ * ShardedEvaluation class
+ * Local coordinator running a DatasetRunner workload in separate worker processes,
+ * so trackers with process-global state (opentld, struck) can use every core.
+ * Shards are handed out to the workers through pipes as they become idle.
+ * A worker that crashes is restarted and its shard is retried once.
+ * Shard results and timing are merged into one result per (sequence, method) pair.
+ *
+ * Worker processes need fork (POSIX). Elsewhere the shards run in the calling process.
+ */
+class ShardedEvaluation
+{
+private:
+    size_t _workers;
+    size_t _shardFrames;
+    size_t _crashes;
+
+public:
+    /**
+     * @param workers: number of worker processes. 0 uses all the cores
+     * @param shardFrames: maximum frames per shard. 0 makes one shard per sequence
+     */
+    ShardedEvaluation(size_t workers = 0, size_t shardFrames = 0):
+        _workers(workers), _shardFrames(shardFrames), _crashes(0)
+    {}
+
+    /**
+     * Tracks the frames of a shard in the current process
+     * @return false if the shard could not be tracked
+     */
+    static bool run(const string &sequence,
+                    const Ptr<Tracker> &tracker,
+                    const Shard &shard,
+                    vector<vector<Point2f> > &trajectory,
+                    RunResult &result);
+
+    /**
+     * Runs every method over every sequence, see DatasetRunner::run
+     */
+    void run(const vector<string> &sequences,
+             const vector<string> &methods,
+             const DatasetRunner::TrackerCreator &creator,
+             const string &folder,
+             vector<RunResult> &results);
+
+    /**
+     * Number of worker processes that crashed during the last run
+     */
+    size_t crashes() const
+    {
+        return _crashes;
+    }
+};
+
+#endif /* defined(__trackers__sharded_evaluation__) */
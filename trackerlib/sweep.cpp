@@ -0,0 +1,330 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "sweep.h"
+#include "factories.h"
+#include <iomanip>
+
+string SweepSpace::format(const SweepParameter &parameter, double value)
+{
+    ostringstream ss;
+    if (parameter.integer)
+        ss << (long long)std::floor(value + 0.5);
+    else
+        ss << std::setprecision(6) << value;
+    return ss.str();
+}
+
+bool SweepSpace::parse(const string &description)
+{
+    _parameters.clear();
+    
+    vector<string> items;
+    GroundTruth::split<string>(description, ';', items);
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        size_t equal = items[i].find('=');
+        if (equal == string::npos || equal == 0)
+            return false;
+        
+        SweepParameter parameter;
+        parameter.name = items[i].substr(0, equal);
+        string values  = items[i].substr(equal + 1);
+        
+        if (values.find(':') == string::npos)
+        {
+            GroundTruth::split<string>(values, ',', parameter.values);
+            if (parameter.values.empty())
+                return false;
+        }
+        else
+        {
+            vector<string> range;
+            GroundTruth::split<string>(values, ':', range);
+            if (range.size() < 2)
+                return false;
+            parameter.low  = atof(range[0].c_str());
+            parameter.high = atof(range[1].c_str());
+            parameter.integer = range[0].find_first_of(".eE") == string::npos &&
+                                range[1].find_first_of(".eE") == string::npos;
+            for (size_t k = 2; k < range.size(); ++k)
+            {
+                if (range[k] == "log")
+                    parameter.logScale = true;
+                else
+                    parameter.steps = std::max(1, atoi(range[k].c_str()));
+            }
+            if (parameter.logScale && (parameter.low <= 0 || parameter.high <= 0))
+                return false;
+        }
+        _parameters.push_back(parameter);
+    }
+    return !_parameters.empty();
+}
+
+void SweepSpace::grid(vector<Configuration> &configurations) const
+{
+    configurations.assign(1, Configuration());
+    for (size_t i = 0; i < _parameters.size(); ++i)
+    {
+        const SweepParameter &parameter = _parameters[i];
+        vector<string> values(parameter.values);
+        if (values.empty())
+        {
+            for (size_t k = 0; k < parameter.steps; ++k)
+            {
+                double t = (parameter.steps > 1) ? k / (double)(parameter.steps - 1) : 0;
+                double value = parameter.logScale ?
+                    std::exp(std::log(parameter.low) + t * (std::log(parameter.high) - std::log(parameter.low))) :
+                    parameter.low + t * (parameter.high - parameter.low);
+                string formatted = format(parameter, value);
+                if (std::find(values.begin(), values.end(), formatted) == values.end())
+                    values.push_back(formatted);
+            }
+        }
+        
+        vector<Configuration> expanded;
+        for (size_t c = 0; c < configurations.size(); ++c)
+        {
+            for (size_t k = 0; k < values.size(); ++k)
+            {
+                expanded.push_back(configurations[c]);
+                expanded.back().push_back("--" + parameter.name + "=" + values[k]);
+            }
+        }
+        configurations.swap(expanded);
+    }
+}
+
+void SweepSpace::random(size_t samples, uint64_t seed, vector<Configuration> &configurations) const
+{
+    configurations.clear();
+    RNG rng(seed + 1);
+    for (size_t s = 0; s < samples; ++s)
+    {
+        Configuration configuration;
+        for (size_t i = 0; i < _parameters.size(); ++i)
+        {
+            const SweepParameter &parameter = _parameters[i];
+            string value;
+            if (!parameter.values.empty())
+                value = parameter.values[rng.uniform(0, (int)parameter.values.size())];
+            else if (parameter.logScale)
+                value = format(parameter, std::exp(rng.uniform(std::log(parameter.low), std::log(parameter.high))));
+            else
+                value = format(parameter, rng.uniform(parameter.low, parameter.high));
+            configuration.push_back("--" + parameter.name + "=" + value);
+        }
+        configurations.push_back(configuration);
+    }
+}
+
+void ParameterSweep::run(const string &method,
+                         const vector<string> &sequences,
+                         const vector<SweepSpace::Configuration> &configurations,
+                         vector<SweepResult> &results,
+                         size_t jobs,
+                         bool retime)
+{
+    results.clear();
+    results.resize(configurations.size());
+    vector<size_t> indices(configurations.size());
+    for (size_t c = 0; c < configurations.size(); ++c)
+    {
+        results[c].options = configurations[c];
+        indices[c] = c;
+    }
+    
+    if (jobs == 0)
+        jobs = ThreadBudget::share();
+    jobs = evaluate(method, sequences, indices, results, jobs);
+    aggregate(results);
+    for (size_t c = 0; c < results.size(); ++c)
+        results[c].serial = (jobs == 1);
+    pareto(results);
+    
+    //concurrent configurations slow each other down, time the front again one at a time
+    if (!retime || jobs < 2)
+        return;
+    indices.clear();
+    for (size_t c = 0; c < results.size(); ++c)
+    {
+        if (!results[c].pareto)
+            continue;
+        results[c] = SweepResult();
+        results[c].options = configurations[c];
+        indices.push_back(c);
+    }
+    evaluate(method, sequences, indices, results, 1);
+    aggregate(results);
+    for (size_t i = 0; i < indices.size(); ++i)
+        results[indices[i]].serial = true;
+    pareto(results);
+}
+
+size_t ParameterSweep::evaluate(const string &method,
+                                const vector<string> &sequences,
+                                const vector<size_t> &indices,
+                                vector<SweepResult> &results,
+                                size_t jobs)
+{
+    ThreadBudget::Lease lease(std::max((size_t)1, std::min(jobs, indices.size())));
+    jobs = lease.threads();
+    //the OpenCV pool of every job is limited to its share, set once for the whole run
+    ThreadBudget::OpenCVThreads openCV(lease.share());
+    
+    for (size_t s = 0; s < sequences.size(); ++s)
+    {
+        //decode the sequence once, shared by every configuration
+        vector<Mat> frames;
+        vector<vector<Point2f> > gt;
+        Ptr<Input> input = TrackerFactory::createInput(sequences[s]);
+        TrackerFactory::findGroundTruth(sequences[s], gt);
+        Mat frame;
+        while (input && frames.size() < gt.size() && input->getFrame(frame))
+            frames.push_back(frame.clone());
+        if (frames.empty())
+            continue;
+        
+        atomic<size_t> next(0);
+        auto worker = [&]()
+        {
+            ThreadBudget::Scope scope(lease.share());
+            for (size_t i = next++; i < indices.size(); i = next++)
+            {
+                const size_t c = indices[i];
+                vector<const char *> argv(1, method.c_str());
+                for (size_t k = 0; k < results[c].options.size(); ++k)
+                    argv.push_back(results[c].options[k].c_str());
+                
+                Ptr<Tracker> tracker;
+                {
+                    lock_guard<mutex> guard(_creation);
+                    tracker = TrackerFactory::createTracker(method, (int)argv.size(), argv.data());
+                }
+                
+                SupervisedResult result;
+                result.sequence = sequences[s];
+                result.method   = method;
+                if (_evaluation.run(new MemoryInput(frames), gt, tracker, result))
+                {
+                    result.trajectory.clear();
+                    results[c].results.push_back(result);
+                }
+            }
+        };
+        
+        vector<thread> workers;
+        for (size_t i = 1; i < jobs; ++i)
+            workers.push_back(thread(worker));
+        worker();
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+    return jobs;
+}
+
+void ParameterSweep::aggregate(vector<SweepResult> &results) const
+{
+    for (size_t c = 0; c < results.size(); ++c)
+    {
+        SweepResult &sweep = results[c];
+        size_t validFrames = 0;
+        double overlapSum  = 0;
+        sweep.frames        = 0;
+        sweep.failures      = 0;
+        sweep.trackTime     = 0;
+        sweep.trackedFrames = 0;
+        for (size_t s = 0; s < sweep.results.size(); ++s)
+        {
+            const SupervisedResult &result = sweep.results[s];
+            sweep.frames        += result.frames;
+            sweep.failures      += result.failures;
+            sweep.trackTime     += result.trackTime;
+            sweep.trackedFrames += result.trackedFrames;
+            validFrames         += result.validFrames;
+            overlapSum          += result.accuracy * result.validFrames;
+        }
+        sweep.accuracy = (validFrames > 0) ? overlapSum / validFrames : 0;
+        sweep.eao      = _evaluation.eao(sweep.results);
+    }
+}
+
+void ParameterSweep::pareto(vector<SweepResult> &results)
+{
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        results[i].pareto = true;
+        for (size_t j = 0; j < results.size() && results[i].pareto; ++j)
+        {
+            bool noWorse = results[j].fps() >= results[i].fps() && results[j].eao >= results[i].eao;
+            bool better  = results[j].fps() >  results[i].fps() || results[j].eao >  results[i].eao;
+            if (j != i && noWorse && better)
+                results[i].pareto = false;
+        }
+    }
+}
+
+void ParameterSweep::table(const vector<SweepResult> &results, ostream &out)
+{
+    vector<size_t> order(results.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return results[a].fps() > results[b].fps(); });
+    
+    out << std::left << std::setw(8) << "pareto"
+        << std::right << std::setw(10) << "fps"
+        << std::setw(10) << "eao"
+        << std::setw(10) << "accuracy"
+        << std::setw(10) << "failures"
+        << "  " << "options" << endl;
+    
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const SweepResult &result = results[order[i]];
+        out << std::left << std::setw(8) << (result.pareto ? "*" : "")
+            << std::right << std::fixed << std::setprecision(2)
+            << std::setw(9) << result.fps() << (result.serial ? " " : "~")
+            << std::setprecision(3)
+            << std::setw(10) << result.eao
+            << std::setw(10) << result.accuracy
+            << std::setw(10) << result.failures << " ";
+        for (size_t k = 0; k < result.options.size(); ++k)
+            out << " " << result.options[k];
+        out << endl;
+    }
+    if (std::any_of(results.begin(), results.end(), [](const SweepResult &r) { return !r.serial; }))
+        out << "~ fps measured while other configurations were running concurrently" << endl;
+}
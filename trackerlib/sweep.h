@@ -0,0 +1,198 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2016 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __trackers__sweep__
+#define __trackers__sweep__
+
+#include "evaluation.h"
+#include <cstdint>
+
+
+using namespace viva;
+using namespace std;
+using namespace cv;
+
+/**
+ * SweepParameter struct
+ * Values explored for one tracker option: an explicit list of values
+ * or a numeric range.
+ */
+struct SweepParameter
+{
+    string name;            /**< option name as parsed by TrackerFactory::createTracker*/
+    vector<string> values;  /**< explicit values. If empty the range is used*/
+    double low;             /**< lower bound of the range*/
+    double high;            /**< upper bound of the range*/
+    size_t steps;           /**< number of grid values of the range*/
+    bool logScale;          /**< range sampled in logarithmic scale*/
+    bool integer;           /**< range of integer values*/
+
+    SweepParameter():
+        name(), values(), low(0), high(0), steps(3), logScale(false), integer(false)
+    {}
+};
+
+/**
+ * SweepSpace class
+ * Search space of tracker options. It is described as a semicolon separated list of
+ * name=v1,v2,... (explicit values) or name=low:high[:steps][:log] (ranges), e.g.,
+ * "padding=1.5,2,2.5;lambda=1e-5:1e-3:3:log;cell=1:4".
+ * Ranges written with integer bounds only produce integer values.
+ */
+class SweepSpace
+{
+public:
+    /**
+     * Command line options of one configuration, e.g., --padding=2
+     */
+    typedef vector<string> Configuration;
+
+private:
+    vector<SweepParameter> _parameters;
+
+    static string format(const SweepParameter &parameter, double value);
+
+public:
+    /**
+     * Parses a search space description
+     * @return false if the description is not valid
+     */
+    bool parse(const string &description);
+    /**
+     * Every combination of the parameter values. Ranges contribute their grid steps.
+     */
+    void grid(vector<Configuration> &configurations) const;
+    /**
+     * Random configurations. Ranges are sampled continuously.
+     */
+    void random(size_t samples, uint64_t seed, vector<Configuration> &configurations) const;
+
+    const vector<SweepParameter> &parameters() const
+    {
+        return _parameters;
+    }
+};
+
+/**
+ * SweepResult struct
+ * Supervised evaluation of one configuration over all the sequences of the sweep.
+ */
+struct SweepResult
+{
+    SweepSpace::Configuration options;  /**< command line options of the configuration*/
+    vector<SupervisedResult> results;   /**< one result per evaluated sequence, without trajectories*/
+    size_t frames;                      /**< evaluated frames*/
+    size_t failures;                    /**< tracking failures*/
+    double accuracy;                    /**< average overlap over the valid frames of every sequence*/
+    double eao;                         /**< expected average overlap*/
+    double trackTime;                   /**< seconds spent in Tracker::processFrame*/
+    size_t trackedFrames;               /**< calls to Tracker::processFrame*/
+    bool pareto;                        /**< not dominated in speed and EAO by another configuration*/
+    bool serial;                        /**< timed with no other configuration running. Otherwise fps is measured under load*/
+
+    SweepResult():
+        options(), results(), frames(0), failures(0), accuracy(0), eao(0),
+        trackTime(0), trackedFrames(0), pareto(false), serial(false)
+    {}
+
+    double fps() const
+    {
+        return (trackTime > 0) ? trackedFrames / trackTime : 0;
+    }
+};
+
+/**
+ * ParameterSweep class
+ * Evaluates many configurations of a tracker over a list of sequences.
+ * Each sequence is decoded once and kept in memory while all the configurations
+ * are evaluated on it in parallel, so only one decoded sequence is alive at a time.
+ */
+class ParameterSweep
+{
+private:
+    SupervisedEvaluation _evaluation;
+    mutex _creation;
+    
+    /**
+     * Evaluates the configurations at the given indices over every sequence
+     * and appends a result per sequence to each of them.
+     * @return the number of jobs actually used
+     */
+    size_t evaluate(const string &method,
+                    const vector<string> &sequences,
+                    const vector<size_t> &indices,
+                    vector<SweepResult> &results,
+                    size_t jobs);
+    
+    /**
+     * Sums the per-sequence results of every configuration
+     */
+    void aggregate(vector<SweepResult> &results) const;
+
+public:
+    ParameterSweep(const SupervisedConfig &config = SupervisedConfig()):
+        _evaluation(config), _creation()
+    {}
+
+    /**
+     * Runs the supervised evaluation of every configuration over every sequence.
+     * Trackers with process-global state (opentld, struck) should be run with jobs = 1.
+     * With jobs > 1 the configurations slow each other down and their fps are measured under load.
+     * @param method: tracking method identifier
+     * @param sequences: list of sequence identifiers (see TrackerFactory::createInput)
+     * @param configurations: tracker options of each configuration
+     * @param results: one result per configuration, in the same order
+     * @param jobs: number of configurations evaluated concurrently. 0 uses all the cores
+     * @param retime: evaluate the Pareto front again one configuration at a time for unloaded fps
+     */
+    void run(const string &method,
+             const vector<string> &sequences,
+             const vector<SweepSpace::Configuration> &configurations,
+             vector<SweepResult> &results,
+             size_t jobs = 0,
+             bool retime = false);
+
+    /**
+     * Marks the configurations in the speed/EAO Pareto front
+     */
+    static void pareto(vector<SweepResult> &results);
+
+    /**
+     * Writes the configurations sorted by speed with their accuracy, failures and EAO.
+     * Pareto optimal configurations are marked with '*', fps measured under load with '~'.
+     */
+    static void table(const vector<SweepResult> &results, ostream &out);
+};
+
+#endif /* defined(__trackers__sweep__) */
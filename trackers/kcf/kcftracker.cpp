@@ -87,6 +87,7 @@ the use of this software, even if advised of the possibility of such damage.
 #include "fhog.hpp"
 #include "labdata.hpp"
 #endif
+#include "trace.h"
 
 // Constructor
 KCFTracker::KCFTracker(bool hog, bool fixed_window, bool multiscale, bool lab)
@@ -163,6 +164,7 @@ KCFTracker::KCFTracker(bool hog, bool fixed_window, bool multiscale, bool lab)
 void KCFTracker::initialize(const cv::Mat &image,
            const cv::Rect &roi)
 {
+    VIVA_TRACE_SCOPE("KCF::initialize");
     _roi = roi;
     assert(roi.width >= 0 && roi.height >= 0);
     _tmpl = getFeatures(image, 1);
@@ -176,6 +178,7 @@ void KCFTracker::initialize(const cv::Mat &image,
 //cv::Rect KCFTracker::update(cv::Mat image)
 void  KCFTracker::processFrame(const cv::Mat &image)
 {
+    VIVA_TRACE_SCOPE("KCF::processFrame");
     if (_roi.x + _roi.width <= 0) _roi.x = -_roi.width + 1;
     if (_roi.y + _roi.height <= 0) _roi.y = -_roi.height + 1;
     if (_roi.x >= image.cols - 1) _roi.x = image.cols - 2;
@@ -233,6 +236,7 @@ void  KCFTracker::processFrame(const cv::Mat &image)
 // Detect object in the current frame.
 cv::Point2f KCFTracker::detect(cv::Mat z, cv::Mat x, float &peak_value)
 {
+    VIVA_TRACE_SCOPE("KCF::detect");
     using namespace FFTTools;
 
     cv::Mat k = gaussianCorrelation(x, z);
@@ -264,6 +268,7 @@ cv::Point2f KCFTracker::detect(cv::Mat z, cv::Mat x, float &peak_value)
 // train tracker with a single image
 void KCFTracker::train(cv::Mat x, float train_interp_factor)
 {
+    VIVA_TRACE_SCOPE("KCF::train");
     using namespace FFTTools;
 
     cv::Mat k = gaussianCorrelation(x, x);
@@ -345,6 +350,7 @@ cv::Mat KCFTracker::createGaussianPeak(int sizey, int sizex)
 // Obtain sub-window from image, with replication-padding and extract features
 cv::Mat KCFTracker::getFeatures(const cv::Mat & image, bool inithann, float scale_adjust)
 {
+    VIVA_TRACE_SCOPE("KCF::getFeatures");
     cv::Rect extracted_roi;
 
     float cx = _roi.x + _roi.width / 2;
@@ -1,7 +1,9 @@
 #include "kcf.h"
+#include "trace.h"
 
 void KCF_Tracker::init(const cv::Mat &img, BBox_c &bbox)
 {
+    VIVA_TRACE_SCOPE("KCF2::init");
     p_pose = bbox;
 
     cv::Mat input;
@@ -72,6 +74,7 @@ BBox_c KCF_Tracker::getBBox()
 
 void KCF_Tracker::track(const cv::Mat &img)
 {
+    VIVA_TRACE_SCOPE("KCF2::track");
     cv::Mat input;
     if (img.channels() == 3){
         cv::cvtColor(img, input, CV_BGR2GRAY);
@@ -324,6 +327,7 @@ cv::Mat KCF_Tracker::get_subwindow(const cv::Mat &input, int cx, int cy, int wid
 
 ComplexMat KCF_Tracker::gaussian_correlation(const ComplexMat &xf, const ComplexMat &yf, double sigma, bool auto_correlation)
 {
+    VIVA_TRACE_SCOPE("KCF2::gaussian_correlation");
     float xf_sqr_norm = xf.sqr_norm();
     float yf_sqr_norm = auto_correlation ? xf_sqr_norm : yf.sqr_norm();
 
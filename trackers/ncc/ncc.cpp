@@ -33,10 +33,12 @@
  **************************************************************************************************/
 
 #include "ncc.h"
+#include "trace.h"
 
 
 void NCCTracker::initialize(const cv::Mat &img, const cv::Rect &rect)
 {
+    VIVA_TRACE_SCOPE("NCC::initialize");
     //Hold the maximum dimension of the selected area.
     p_window = MAX(rect.width, rect.height);
 
@@ -61,6 +63,7 @@ void NCCTracker::initialize(const cv::Mat &img, const cv::Rect &rect)
 }
 void NCCTracker::processFrame(const cv::Mat &img)
 {
+    VIVA_TRACE_SCOPE("NCC::processFrame");
     //Selecting an area of the image based in the previous
     //detected target location and in their max dimension
     //among the two axis. The areas are carefully selected without exceeding
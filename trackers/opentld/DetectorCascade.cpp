@@ -29,6 +29,8 @@
 #include <algorithm>
 
 #include "TLDUtil.h"
+#include "thread_budget.h"
+#include "trace.h"
 
 using namespace cv;
 
@@ -270,6 +272,7 @@ void DetectorCascade::initWindowOffsets()
 
 void DetectorCascade::detect(const Mat &img)
 {
+    VIVA_TRACE_SCOPE("DetectorCascade::detect");
     //For every bounding box, the output is confidence, pattern, variance
 
     detectionResult->reset();
@@ -284,7 +287,11 @@ void DetectorCascade::detect(const Mat &img)
     varianceFilter->nextIteration(img); //Calculates integral images
     ensembleClassifier->nextIteration(img);
 
-    #pragma omp parallel for
+#ifdef _OPENMP
+    //the threads of the loop are leased from the project-wide budget
+    viva::ThreadBudget::Lease lease(0);
+    #pragma omp parallel for num_threads(lease.threads())
+#endif
 
     for(int i = 0; i < numWindows; i++)
     {
@@ -29,6 +29,7 @@
 #include <cmath>
 
 #include "FBTrack.h"
+#include "trace.h"
 
 using namespace cv;
 
@@ -53,6 +54,7 @@ void MedianFlowTracker::cleanPreviousData()
 
 void MedianFlowTracker::track(const Mat &prevMat, const Mat &currMat, Rect *prevBB)
 {
+    VIVA_TRACE_SCOPE("MedianFlowTracker::track");
     if(prevBB != NULL)
     {
         if(prevBB->width <= 0 || prevBB->height <= 0)
@@ -29,6 +29,7 @@
 
 #include "NNClassifier.h"
 #include "TLDUtil.h"
+#include "trace.h"
 
 using namespace std;
 using namespace cv;
@@ -147,6 +148,7 @@ void TLD::selectObject(const Mat &img, Rect *bb)
 
 void TLD::processImage(const Mat &img)
 {
+    VIVA_TRACE_SCOPE("TLD::processImage");
     storeCurrentData();
     currImg = img; // Store new image , right after storeCurrentData();
 
@@ -239,6 +241,7 @@ void TLD::fuseHypotheses()
 
 void TLD::initialLearning()
 {
+    VIVA_TRACE_SCOPE("TLD::initialLearning");
     learning = true; //This is just for display purposes
 
     DetectionResult *detectionResult = detectorCascade->detectionResult;
@@ -323,6 +326,7 @@ void TLD::initialLearning()
 //Do this when current trajectory is valid
 void TLD::learn()
 {
+    VIVA_TRACE_SCOPE("TLD::learn");
     if(!learningEnabled || !valid || !detectorEnabled)
     {
         learning = false;
@@ -48,10 +48,16 @@ class OpenTLD: public Tracker
 {
     
     Ptr<TLD> tld;
+    int numTrees;
+    int numFeatures;
     
 public:
     
-    OpenTLD():tld()
+    /*
+     * @param trees: number of trees of the ensemble classifier
+     * @param features: number of pixel comparisons per tree
+     */
+    OpenTLD(int trees = 10, int features = 10):tld(), numTrees(trees), numFeatures(features)
     {
         
     }
@@ -109,8 +115,8 @@ public:
         tld->detectorCascade->minScale = -10;
         tld->detectorCascade->maxScale = 10;
         tld->detectorCascade->minSize = 25;
-        tld->detectorCascade->numTrees = 10;
-        tld->detectorCascade->numFeatures = 10;
+        tld->detectorCascade->numTrees = numTrees;
+        tld->detectorCascade->numFeatures = numFeatures;
         tld->detectorCascade->nnClassifier->thetaTP = 0.65;
         tld->detectorCascade->nnClassifier->thetaFP = 0.5;
         srand(0);
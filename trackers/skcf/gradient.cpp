@@ -62,14 +62,14 @@ float* acosTable() {
 }
 
 // compute gradient magnitude and orientation at each location (uses sse)
-void gradMag( float *I, float *M, float *O, int h, int w, int d, bool full ) {
+void gradMag( float *I, float *M, float *O, int h, int w, int d, bool full, float *buffer ) {
     int x, y, y1, c, h4, s; float *Gx, *Gy, *M2; __m128 *_Gx, *_Gy, *_M2, _m;
     float *acost = acosTable(), acMult=10000.0f;
     // allocate memory for storing one column of output (padded so h4%4==0)
     h4=(h%4==0) ? h : h-(h%4)+4; s=d*h4*sizeof(float);
-    M2=(float*) alMalloc(s,16); _M2=(__m128*) M2;
-    Gx=(float*) alMalloc(s,16); _Gx=(__m128*) Gx;
-    Gy=(float*) alMalloc(s,16); _Gy=(__m128*) Gy;
+    if( buffer ) { M2=buffer; Gx=buffer+d*h4; Gy=buffer+2*d*h4; }
+    else { M2=(float*) alMalloc(s,16); Gx=(float*) alMalloc(s,16); Gy=(float*) alMalloc(s,16); }
+    _M2=(__m128*) M2; _Gx=(__m128*) Gx; _Gy=(__m128*) Gy;
     // compute gradient magnitude and orientation for each column
     for( x=0; x<w; x++ ) {
         // compute gradients (Gx, Gy) with maximum squared magnitude (M2)
@@ -102,7 +102,7 @@ void gradMag( float *I, float *M, float *O, int h, int w, int d, bool full ) {
             for( ; y<h; y++ ) O[y+x*h]+=(Gy[y]<0)*PI;
         }
     }
-    alFree(Gx); alFree(Gy); alFree(M2);
+    if( !buffer ) { alFree(Gx); alFree(Gy); alFree(M2); }
 }
 
 // normalize gradient magnitude at each location (uses sse)
@@ -152,13 +152,18 @@ void gradQuantize( float *O, float *M, int *O0, int *O1, float *M0, float *M1,
 
 // compute nOrients gradient histograms per bin x bin block of pixels
 void gradHist( float *M, float *O, float *H, int h, int w,
-              int bin, int nOrients, int softBin, bool full )
+              int bin, int nOrients, int softBin, bool full, float *buffer )
 {
     const int hb=h/bin, wb=w/bin, h0=hb*bin, w0=wb*bin, nb=wb*hb;
+    const int h4=(h%4==0) ? h : h-(h%4)+4;
     const float s=(float)bin, sInv=1/s, sInv2=1/s/s;
     float *H0, *H1, *M0, *M1; int x, y; int *O0, *O1; float xb, init;
-    O0=(int*)alMalloc(h*sizeof(int),16); M0=(float*) alMalloc(h*sizeof(float),16);
-    O1=(int*)alMalloc(h*sizeof(int),16); M1=(float*) alMalloc(h*sizeof(float),16);
+    if( buffer ) {
+        O0=(int*)buffer; M0=buffer+h4; O1=(int*)(buffer+2*h4); M1=buffer+3*h4;
+    } else {
+        O0=(int*)alMalloc(h*sizeof(int),16); M0=(float*) alMalloc(h*sizeof(float),16);
+        O1=(int*)alMalloc(h*sizeof(int),16); M1=(float*) alMalloc(h*sizeof(float),16);
+    }
     // main loop
     for( x=0; x<w0; x++ ) {
         // compute target orientation bins for entire column - very fast
@@ -226,7 +231,7 @@ ms[0]=1-xd-yd+xyd; ms[1]=yd-xyd; ms[2]=xd-xyd; ms[3]=xyd;
 #undef GH
         }
     }
-    alFree(O0); alFree(O1); alFree(M0); alFree(M1);
+    if( !buffer ) { alFree(O0); alFree(O1); alFree(M0); alFree(M1); }
     // normalize boundary bins which only get 7/8 of weight of interior bins
     if( softBin%2!=0 ) for( int o=0; o<nOrients; o++ ) {
         x=0; for( y=0; y<hb; y++ ) H[o*nb+x*hb+y]*=8.f/7.f;
@@ -239,10 +244,12 @@ ms[0]=1-xd-yd+xyd; ms[1]=yd-xyd; ms[2]=xd-xyd; ms[3]=xyd;
 /******************************************************************************/
 
 // HOG helper: compute 2x2 block normalization values (padded by 1 pixel)
-float* hogNormMatrix( float *H, int nOrients, int hb, int wb, int bin ) {
-    float *N, *N1, *n; int o, x, y, dx, dy, hb1=hb+1, wb1=wb+1;
+float* hogNormMatrix( float *H, int nOrients, int hb, int wb, int bin, float *N ) {
+    float *N1, *n; int o, x, y, dx, dy, hb1=hb+1, wb1=wb+1;
     float eps = 1e-4f/4/bin/bin/bin/bin; // precise backward equality
-    N = (float*) wrCalloc(hb1*wb1,sizeof(float)); N1=N+hb1+1;
+    if( N ) memset(N,0,hb1*wb1*sizeof(float));
+    else N = (float*) wrCalloc(hb1*wb1,sizeof(float));
+    N1=N+hb1+1;
     for( o=0; o<nOrients; o++ ) for( x=0; x<wb; x++ ) for( y=0; y<hb; y++ )
         N1[x*hb1+y] += H[o*wb*hb+x*hb+y]*H[o*wb*hb+x*hb+y];
     for( x=0; x<wb-1; x++ ) for( y=0; y<hb-1; y++ ) {
@@ -302,25 +309,44 @@ void hog( float *M, float *O, float *H, int h, int w, int binSize,
 }
 
 // compute FHOG features
+static inline size_t align4( size_t n ) { return (n+3) & ~size_t(3); }
+
+size_t fhogScratch( int h, int w, int d, int binSize, int nOrients )
+{
+    const size_t hb=h/binSize, wb=w/binSize, nb=hb*wb, h4=align4(h);
+    // gradMag runs first, fhog reuses the same memory afterwards
+    size_t mag  = 3*d*h4;
+    size_t hist = align4(nb*nOrients*2) + align4(nb*nOrients) +
+                  align4((hb+1)*(wb+1)) + 4*h4;
+    return mag > hist ? mag : hist;
+}
+
 void fhog( float *M, float *O, float *H, int h, int w, int binSize,
-          int nOrients, int softBin, float clip )
+          int nOrients, int softBin, float clip, float *buffer )
 {
     const int hb=h/binSize, wb=w/binSize, nb=hb*wb, nbo=nb*nOrients;
-    float *N, *R1, *R2; int o, x;
+    float *N, *R1, *R2, *S=0; int o, x;
+    if( buffer ) {
+        R1=buffer; R2=R1+align4(nb*nOrients*2);
+        N=R2+align4(nb*nOrients); S=N+align4((hb+1)*(wb+1));
+        memset(R1,0,nb*nOrients*2*sizeof(float));
+    } else {
+        R1 = (float*) wrCalloc(wb*hb*nOrients*2,sizeof(float));
+        R2 = (float*) wrCalloc(wb*hb*nOrients,sizeof(float));
+        N  = 0;
+    }
     // compute unnormalized constrast sensitive histograms
-    R1 = (float*) wrCalloc(wb*hb*nOrients*2,sizeof(float));
-    gradHist( M, O, R1, h, w, binSize, nOrients*2, softBin, true );
+    gradHist( M, O, R1, h, w, binSize, nOrients*2, softBin, true, S );
     // compute unnormalized contrast insensitive histograms
-    R2 = (float*) wrCalloc(wb*hb*nOrients,sizeof(float));
     for( o=0; o<nOrients; o++ ) for( x=0; x<nb; x++ )
         R2[o*nb+x] = R1[o*nb+x]+R1[(o+nOrients)*nb+x];
     // compute block normalization values
-    N = hogNormMatrix( R2, nOrients, hb, wb, binSize );
+    N = hogNormMatrix( R2, nOrients, hb, wb, binSize, N );
     // normalized histograms and texture channels
     hogChannels( H+nbo*0, R1, N, hb, wb, nOrients*2, clip, 1 );
     hogChannels( H+nbo*2, R2, N, hb, wb, nOrients*1, clip, 1 );
     hogChannels( H+nbo*3, R1, N, hb, wb, nOrients*2, clip, 2 );
-    wrFree(N); wrFree(R1); wrFree(R2);
+    if( !buffer ) { wrFree(N); wrFree(R1); wrFree(R2); }
 }
 
 /******************************************************************************/
@@ -338,59 +364,80 @@ void gradientMagnitude(const cv::Mat &image, float *M, float *O)
 }
 
 
+/*
+ * Column major image, gradients, histograms and toolbox scratch of an
+ * fhog call, carved from the buffer of the caller. H is zeroed.
+ */
+static void fhogBuffers(const cv::Mat &image, int binSize, int orientations,
+                        FHogBuffer &buffer,
+                        float *&I, float *&M, float *&O, float *&H, float *&scratch)
+{
+    const int h = image.rows, w = image.cols, d = image.channels();
+    const size_t nH = (size_t)(h / binSize) * (w / binSize) * (orientations * 3 + 5);
+    const size_t sI = align4((size_t)h * w * d), sM = align4((size_t)h * w), sH = align4(nH);
+    I       = buffer.reserve(sI + 2 * sM + sH + fhogScratch(h, w, d, binSize, orientations));
+    M       = I + sI;
+    O       = M + sM;
+    H       = O + sM;
+    scratch = H + sH;
+    fill_n(H, nH, 0);
+    
+    if (d == 3)
+        OpenCVBGR_MatlabRGB(image, I);
+    else
+        OpenCV2MatlabC1(image, I);
+}
+
 void fhog(const cv::Mat &image, vector<Mat> &fhogs, int binSize, int orientations)
+{
+    FHogBuffer buffer;
+    fhog(image, fhogs, binSize, orientations, buffer);
+}
+
+void fhog(const cv::Mat &image, vector<Mat> &fhogs, int binSize, int orientations, FHogBuffer &buffer)
 {
     assert(image.type() == CV_32F || image.type() == CV_32FC3);
     assert(image.isContinuous());
-    float *M = new float[image.rows * image.cols];
-    float *O = new float[image.rows * image.cols];
-    
     int hb       = image.rows / binSize;
     int wb       = image.cols / binSize;
     int nChannls = orientations * 3 + 5;
     
-    float *H = new float[hb * wb * nChannls];
-    fill_n(H, hb*wb*nChannls, 0);
-    gradientMagnitude(image, M, O);
-    
-    fhog(M, O, H, image.rows, image.cols, binSize, orientations, -1, 0.2f);
+    float *I, *M, *O, *H, *scratch;
+    fhogBuffers(image, binSize, orientations, buffer, I, M, O, H, scratch);
+    gradMag(I, M, O, image.rows, image.cols, image.channels(), true, scratch);
+    fhog(M, O, H, image.rows, image.cols, binSize, orientations, -1, 0.2f, scratch);
     
+    //channels of a previous call are overwritten, reusing their storage
+    fhogs.resize(nChannls);
     for (size_t i = 0; i < nChannls; i++)
     {
-        Mat tmp(Size(wb, hb), CV_32FC1);
-        Matlab2OpenCVC1(H +( i * (wb *hb)), tmp);
-        fhogs.push_back(tmp);
+        fhogs[i].create(Size(wb, hb), CV_32FC1);
+        Matlab2OpenCVC1(H +( i * (wb *hb)), fhogs[i]);
     }
-    
-    delete[] H;
-    delete[] M;
-    delete[] O;
 }
 
 
-
 void fhog(const cv::Mat &image, Mat &fhogs, int binSize, int orientations)
+{
+    FHogBuffer buffer;
+    fhog(image, fhogs, binSize, orientations, buffer);
+}
+
+void fhog(const cv::Mat &image, Mat &fhogs, int binSize, int orientations, FHogBuffer &buffer)
 {
     assert(image.type() == CV_32F || image.type() == CV_32FC3);
-    float *M = new float[image.rows * image.cols];
-    float *O = new float[image.rows * image.cols];
-    
     int hb       = image.rows / binSize;
     int wb       = image.cols / binSize;
     int nChannls = orientations * 3 + 5;
     
-    float *H = new float[hb * wb * nChannls];
+    float *I, *M, *O, *H, *scratch;
+    fhogBuffers(image, binSize, orientations, buffer, I, M, O, H, scratch);
+    gradMag(I, M, O, image.rows, image.cols, image.channels(), true, scratch);
+    fhog(M, O, H, image.rows, image.cols, binSize, orientations, -1, 0.2f, scratch);
     
-    gradientMagnitude(image, M, O);
-    
-    fhog(M, O, H, image.rows, image.cols, binSize, orientations, -1, 0.2f);
-    
-    fhogs = Mat::zeros(Size(wb,hb), CV_32FC(nChannls));
+    //every element is written, the storage of a previous call is reused
+    fhogs.create(Size(wb,hb), CV_32FC(nChannls));
     Matlab2OpenCV(H, fhogs);
-    
-    delete [] H;
-    delete [] M;
-    delete [] O;
 }
 
 
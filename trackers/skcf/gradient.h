@@ -172,6 +172,27 @@ void gradientMagnitude(const cv::Mat &image, cv::Mat &M, cv::Mat&O);
 void fhog(const cv::Mat &image, vector<Mat> &fhogs, int binSize, int orientations);
 void fhog(const cv::Mat &image, Mat &fhogs, int binSize, int orientations);
 
+/* Scratch memory of fhog owned by the caller: the image in column major
+ * order, the gradients, the histograms and the column buffers of the
+ * toolbox. It only grows, so calls on images of the same size reuse it. */
+class FHogBuffer
+{
+public:
+    //  16 byte aligned storage for at least n floats
+    float* reserve(size_t n)
+    {
+        if (_storage.size() < n + 4)
+            _storage.resize(n + 4);
+        return (float*)(((size_t)_storage.data() + 15) & ~(size_t)15);
+    }
+private:
+    vector<float> _storage;
+};
+
+/* Same as above, the scratch memory comes from buffer */
+void fhog(const cv::Mat &image, vector<Mat> &fhogs, int binSize, int orientations, FHogBuffer &buffer);
+void fhog(const cv::Mat &image, Mat &fhogs, int binSize, int orientations, FHogBuffer &buffer);
+
 /*******************************************************************************
  * Piotr's Computer Vision Matlab Toolbox      Version 3.30
  * Copyright 2014 Piotr Dollar & Ron Appel.  [pdollar-at-gmail.com]
@@ -272,7 +293,8 @@ void grad2( float *I, float *Gx, float *Gy, int h, int w, int d ) ;
 float* acosTable() ;
 
 // compute gradient magnitude and orientation at each location (uses sse)
-void gradMag( float *I, float *M, float *O, int h, int w, int d, bool full );
+// buffer: 16 byte aligned scratch of 3*d*h4 floats (h4 = h rounded up to 4), allocated if 0
+void gradMag( float *I, float *M, float *O, int h, int w, int d, bool full, float *buffer = 0 );
 
 // normalize gradient magnitude at each location (uses sse)
 void gradMagNorm( float *M, float *S, int h, int w, float norm );
@@ -282,13 +304,15 @@ void gradQuantize( float *O, float *M, int *O0, int *O1, float *M0, float *M1,
                   int nb, int n, float norm, int nOrients, bool full, bool interpolate );
 
 // compute nOrients gradient histograms per bin x bin block of pixels
+// buffer: 16 byte aligned scratch of 4*h4 floats (h4 = h rounded up to 4), allocated if 0
 void gradHist( float *M, float *O, float *H, int h, int w,
-              int bin, int nOrients, int softBin, bool full );
+              int bin, int nOrients, int softBin, bool full, float *buffer = 0 );
 
 /******************************************************************************/
 
 // HOG helper: compute 2x2 block normalization values (padded by 1 pixel)
-float* hogNormMatrix( float *H, int nOrients, int hb, int wb, int bin );
+// N: output of (hb+1)*(wb+1) floats, allocated (wrFree) if 0
+float* hogNormMatrix( float *H, int nOrients, int hb, int wb, int bin, float *N = 0 );
 
 // HOG helper: compute HOG or FHOG channels
 void hogChannels( float *H, const float *R, const float *N,
@@ -299,8 +323,12 @@ void hog( float *M, float *O, float *H, int h, int w, int binSize,
          int nOrients, int softBin, bool full, float clip );
 
 // compute FHOG features
+// buffer: 16 byte aligned scratch of fhogScratch(h, w, 1, binSize, nOrients) floats, allocated if 0
 void fhog( float *M, float *O, float *H, int h, int w, int binSize,
-          int nOrients, int softBin, float clip );
+          int nOrients, int softBin, float clip, float *buffer = 0 );
+
+// floats of scratch used by gradMag (d channels) and then by fhog
+size_t fhogScratch( int h, int w, int d, int binSize, int nOrients );
 
 
 
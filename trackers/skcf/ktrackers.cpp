@@ -14,6 +14,8 @@
  **************************************************************************************************/
 #include "ktrackers.h"
 #include <opencv2/highgui/highgui.hpp>
+#include "thread_budget.h"
+#include "trace.h"
 
 
 using namespace std;
@@ -31,6 +33,11 @@ void KTrackers::setArea(const RotatedRect &rect)
     _target.windowSize = Size(w, h);
     _target.model_xf.clear();
     _target.model_alphaf = Mat();
+    _target.cache = TCache();
+    _scaleFilter.reset();
+    _flow.reset();
+    //parameters are final once the target is set
+    _process = specialize(_params);
 }
 
 void KTrackers::getTrackedArea(vector<Point2f> &pts)
@@ -81,11 +88,17 @@ void KTrackers::getPoints(
                         k);
 }
 
+template<KType kernel, KFeat feature, bool complex>
 void KTrackers::processFrame(const cv::Mat &frame)
 {
-    Mat patch, filter;
-    Mat kf, yf, kzf, alphaf;
-    vector<Mat> xf,zf;
+    VIVA_TRACE_SCOPE("sKCF::processFrame");
+    TWorkspace &ws = _target.work;
+    Mat &patch  = ws.patch;
+    Mat &kf     = ws.kf;
+    Mat &kzf    = ws.kzf;
+    Mat &alphaf = ws.alphaf;
+    vector<Mat> &xf = ws.xf;
+    vector<Mat> &zf = ws.zf;
    
     Size sz(_target.windowSize.width/_params.cell_size,
             _target.windowSize.height/_params.cell_size);
@@ -97,36 +110,28 @@ void KTrackers::processFrame(const cv::Mat &frame)
     {
         Point shift;
         KTrackers::getPatch(frame, _target.center, _target.windowSize, patch);
-        KTrackers::hannWindow(sz, filter);
-        KTrackers::getFeatures(patch, _params, filter, zf);
-        KTrackers::fft2(zf, _params);
+        const Mat &filter = KTrackers::cachedHann(sz, _params, _target.cache);
+        KTrackers::getFeatures<feature>(patch, _params, filter, ws.features, ws);
+        KTrackers::fft2<complex>(ws.features, zf, _params);
+        KTrackers::removeMeans<complex>(zf, ws.means, filter, _target.cache.hannF);
+        KTrackers::correlation<kernel, complex>(zf, _target.model_xf, _params, kzf, ws, false);
+        KTrackers::fastDetection(_target.model_alphaf, kzf, shift, ws);
+        Point2f _shift(_params.cell_size * Point2f(shift.x, shift.y));
+        _target.center = _target.center + _shift;
         
-        switch (_params.kernel_type)
+        if (_params.scale)
         {
-            case KType::GAUSSIAN:
+            double scale;
+            if (_params.scale_type == KScaleType::DSST)
             {
-                KTrackers::gaussian_correlation(zf, _target.model_xf,_params, kzf, false);
-                break;
-            }
-            case KType::POLYNOMIAL:
-            {
-                KTrackers::polynomial_correlation(zf, _target.model_xf,_params, kzf);
-                break;
+                _scaleFilter.processFrame(frame, _target.center, _target.size);
+                scale = _scaleFilter.getScale();
             }
-            case KType::LINEAR:
+            else
             {
-                KTrackers::linear_correlation(zf,_target.model_xf, kzf);
-                break;
+                _flow.processFrame(patch, filter, _target.size, _shift);
+                scale = _flow.getScale();
             }
-        }
-        KTrackers::fastDetection(_target.model_alphaf, kzf, shift);
-        Point2f _shift(_params.cell_size * Point2f(shift.x, shift.y));
-        _target.center = _target.center + _shift;
-        
-        if (_params.scale)
-        {
-            _flow.processFrame(patch, filter, _target.size, _shift);
-            double scale = _flow.getScale();
             _target.size = Size2d(min((double)_target.windowSize.width, (_target.size.width * scale)),
                                   min((double)_target.windowSize.height,(_target.size.height * scale)));
         }
@@ -139,16 +144,19 @@ void KTrackers::processFrame(const cv::Mat &frame)
     
     float sigmaW =(float)tsz.width/(float)sz.width;
     float sigmaH =(float)tsz.height/(float)sz.height;
-    KTrackers::gaussianWindow(sz, sigmaW,sigmaH, filter);
-    
-    KTrackers::gaussian_shaped_labels(sigma, sz, yf);
-    KTrackers::fft2(yf, _params);
+    KTrackers::cachedLabels(sz, sigma, sigmaW, sigmaH, _params, _target.cache);
+    const Mat &filter = _target.cache.gaussian;
+    const Mat &yf     = _target.cache.yf;
     
     KTrackers::getPatch(frame, _target.center, _target.windowSize, patch);
     
-    if (_params.scale)
+    if (_params.scale && _params.scale_type == KScaleType::DSST)
+    {
+        _scaleFilter.update(frame, _target.center, _target.size);
+    }
+    else if (_params.scale)
     {
-        _flow.extractPoints(patch, _target.size);
+        _flow.updatePoints(patch, _target.size);
         
         _ptl.x = _target.center.x - floor(_target.windowSize.width/2);
         _ptl.y = _target.center.y - floor(_target.windowSize.height/2);
@@ -159,33 +167,19 @@ void KTrackers::processFrame(const cv::Mat &frame)
 //        KTrackers::hannWindow(sz, filter);
 //    }
 
-    KTrackers::getFeatures(patch, _params, filter, xf);
-    KTrackers::fft2(xf, _params);
-    
-    switch (_params.kernel_type)
-    {
-        case KType::GAUSSIAN:
-        {
-            KTrackers::gaussian_correlation(xf, xf, _params, kf, true);
-            break;
-        }
-        case KType::POLYNOMIAL:
-        {
-            KTrackers::polynomial_correlation(xf, xf, _params, kf);
-            break;
-        }
-        case KType::LINEAR:
-        {
-            KTrackers::linear_correlation(xf, xf, kf);
-            break;
-        }
-    }
-    KTrackers::fastTraining(yf, kf, _params, alphaf);
+    KTrackers::getFeatures<feature>(patch, _params, filter, ws.features, ws);
+    KTrackers::fft2<complex>(ws.features, xf, _params);
+    KTrackers::removeMeans<complex>(xf, ws.means, filter, _target.cache.gaussianF);
+    KTrackers::correlation<kernel, complex>(xf, xf, _params, kf, ws, true);
+    KTrackers::fastTraining<complex>(yf, kf, _params, alphaf);
     
     if (!_target.initiated)
     {
-        _target.model_xf     = xf;
-        _target.model_alphaf = alphaf;
+        //the models keep their own storage, xf and alphaf are reused
+        _target.model_xf.resize(xf.size());
+        for (size_t i = 0; i < xf.size(); ++i)
+            xf[i].copyTo(_target.model_xf[i]);
+        alphaf.copyTo(_target.model_alphaf);
         _target.initiated    = true;
         
     }
@@ -229,26 +223,26 @@ _target(), _params(type, scale),  _ptl(0.,0.)
             break;
         }
     }
+    _process = specialize(_params);
 }
 
 
 
 
-void KTrackers::divSpectrums( InputArray _srcA, InputArray _srcB,
-                   OutputArray _dst, int flags, bool conjB  ,double lambda)
+
+/*
+ * Division of two spectrums of cn channels, cn == 1 being the CCS packed
+ * format and cn == 2 the full complex one. The layout and the depth are
+ * constants, the packed rows and columns are only visited for CCS.
+ */
+template<typename T, int cn>
+static void spectrumDivision(const Mat &srcA, const Mat &srcB, Mat &dst,
+                             int flags, bool conjB, double lambda)
 {
     //lambda is a regularization term. avoid division by 0
-    Mat srcA = _srcA.getMat(), srcB = _srcB.getMat();
-    int depth = srcA.depth(), cn = srcA.channels(), type = srcA.type();
     int rows = srcA.rows, cols = srcA.cols;
     int j, k;
     
-    CV_Assert( type == srcB.type() && srcA.size() == srcB.size() );
-    CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
-    
-    _dst.create( srcA.rows, srcA.cols, type );
-    Mat dst = _dst.getMat();
-    
     bool is_1d = (flags & DFT_ROWS) || (rows == 1 || (cols == 1 &&
                                                       srcA.isContinuous() && srcB.isContinuous() && dst.isContinuous()));
     
@@ -259,202 +253,141 @@ void KTrackers::divSpectrums( InputArray _srcA, InputArray _srcB,
     int j0 = cn == 1;
     int j1 = ncols - (cols % 2 == 0 && cn == 1);
     
-    if( depth == CV_32F )
+    const T* dataA = (const T*)srcA.data;
+    const T* dataB = (const T*)srcB.data;
+    T* dataC = (T*)dst.data;
+    
+    size_t stepA = srcA.step/sizeof(dataA[0]);
+    size_t stepB = srcB.step/sizeof(dataB[0]);
+    size_t stepC = dst.step/sizeof(dataC[0]);
+    
+    if( !is_1d && cn == 1 )
     {
-        const float* dataA = (const float*)srcA.data;
-        const float* dataB = (const float*)srcB.data;
-        float* dataC = (float*)dst.data;
-        
-        size_t stepA = srcA.step/sizeof(dataA[0]);
-        size_t stepB = srcB.step/sizeof(dataB[0]);
-        size_t stepC = dst.step/sizeof(dataC[0]);
-        
-        if( !is_1d && cn == 1 )
+        for( k = 0; k < (cols % 2 ? 1 : 2); k++ )
         {
-            for( k = 0; k < (cols % 2 ? 1 : 2); k++ )
-            {
-                if( k == 1 )
-                    dataA += cols - 1, dataB += cols - 1, dataC += cols - 1;
-                dataC[0] = saturate_cast<float>(dataA[0] / (dataB[0] + lambda));
-                if( rows % 2 == 0 )
-                    dataC[(rows-1)*stepC] = saturate_cast<float>(dataA[(rows-1)*stepA] / (dataB[(rows-1)*stepB] + lambda)) ;
-                if( !conjB )
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        //Ia = a + bi, Ib = b + ci
-                        //Ia/Ib = (a + bi) * ( c - di) / (c^2 + d^2);
-                        //den = c^2 + d^2
-                        //re = ac + bd / den
-                        //im = cb - ad / den
-                        
-                        double _a = (double)dataA[j*stepA];
-                        double _b = (double)dataA[(j+1)*stepA];
-                        double _c = (double)dataB[j*stepB];
-                        double _d = (double)dataB[(j+1)*stepB];
-                        double den = (_c + lambda) * (_c + lambda) + (_d * _d);
-                        double re = _a * _c + _b * _d;
-                        double im = _b * _c - _a * _d;
-                        dataC[j*stepC]     = saturate_cast<float>((re/den));
-                        dataC[(j+1)*stepC] = saturate_cast<float>((im/den));
-                    }
-                else
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        double _a = (double)dataA[j*stepA];
-                        double _b = (double)dataA[(j+1)*stepA];
-                        double _c = (double)dataB[j*stepB];
-                        double _d = (double)dataB[(j+1)*stepB];
-                        double den = (_c + lambda) * (_c + lambda) + (_d * _d);
-                        double re = _a * _c - _b * _d;
-                        double im = _a * _d + _b * _c;
-
-                        dataC[j*stepC] = saturate_cast<float>(re/den);
-                        dataC[(j+1)*stepC] = saturate_cast<float>(im/den);
-                    }
-                if( k == 1 )
-                    dataA -= cols - 1, dataB -= cols - 1, dataC -= cols - 1;
-            }
-        }
-        
-        for( ; rows--; dataA += stepA, dataB += stepB, dataC += stepC )
-        {
-            if( is_1d && cn == 1 )
-            {
-                dataC[0] = dataA[0] / (dataB[0] + lambda);
-                if( cols % 2 == 0 )
-                    dataC[j1] = dataA[j1] / (dataB[j1] + lambda);
-            }
-            
+            if( k == 1 )
+                dataA += cols - 1, dataB += cols - 1, dataC += cols - 1;
+            dataC[0] = saturate_cast<T>(dataA[0] / (dataB[0] + lambda));
+            if( rows % 2 == 0 )
+                dataC[(rows-1)*stepC] = saturate_cast<T>(dataA[(rows-1)*stepA] / (dataB[(rows-1)*stepB] + lambda)) ;
             if( !conjB )
-                for( j = j0; j < j1; j += 2 )
+                for( j = 1; j <= rows - 2; j += 2 )
                 {
                     //Ia = a + bi, Ib = b + ci
                     //Ia/Ib = (a + bi) * ( c - di) / (c^2 + d^2);
                     //den = c^2 + d^2
                     //re = ac + bd / den
                     //im = cb - ad / den
-                    double _a = (double)dataA[j];
-                    double _b = (double)dataA[j+1];
-                    double _c = (double)dataB[j];
-                    double _d = (double)dataB[j+1];
+                    
+                    double _a = (double)dataA[j*stepA];
+                    double _b = (double)dataA[(j+1)*stepA];
+                    double _c = (double)dataB[j*stepB];
+                    double _d = (double)dataB[(j+1)*stepB];
                     double den = (_c + lambda) * (_c + lambda) + (_d * _d);
                     double re = _a * _c + _b * _d;
                     double im = _b * _c - _a * _d;
-                    
-                    dataC[j] = saturate_cast<float>(re/den);
-                    dataC[j+1] = saturate_cast<float>(im/den);
+                    dataC[j*stepC]     = saturate_cast<T>((re/den));
+                    dataC[(j+1)*stepC] = saturate_cast<T>((im/den));
                 }
             else
-                for( j = j0; j < j1; j += 2 )
+                for( j = 1; j <= rows - 2; j += 2 )
                 {
-                    double _a = (double)dataA[j];
-                    double _b = (double)dataA[j+1];
-                    double _c = (double)dataB[j];
-                    double _d = (double)dataB[j+1];
+                    double _a = (double)dataA[j*stepA];
+                    double _b = (double)dataA[(j+1)*stepA];
+                    double _c = (double)dataB[j*stepB];
+                    double _d = (double)dataB[(j+1)*stepB];
                     double den = (_c + lambda) * (_c + lambda) + (_d * _d);
                     double re = _a * _c - _b * _d;
                     double im = _a * _d + _b * _c;
-                    dataC[j] = saturate_cast<float>(re/den);
-                    dataC[j+1] = saturate_cast<float>(im/den);
+
+                    dataC[j*stepC] = saturate_cast<T>(re/den);
+                    dataC[(j+1)*stepC] = saturate_cast<T>(im/den);
                 }
+            if( k == 1 )
+                dataA -= cols - 1, dataB -= cols - 1, dataC -= cols - 1;
         }
     }
-    else
+    
+    for( ; rows--; dataA += stepA, dataB += stepB, dataC += stepC )
     {
-        const double* dataA = (const double*)srcA.data;
-        const double* dataB = (const double*)srcB.data;
-        double* dataC = (double*)dst.data;
-        
-        size_t stepA = srcA.step/sizeof(dataA[0]);
-        size_t stepB = srcB.step/sizeof(dataB[0]);
-        size_t stepC = dst.step/sizeof(dataC[0]);
-        
-        if( !is_1d && cn == 1 )
+        if( is_1d && cn == 1 )
         {
-            for( k = 0; k < (cols % 2 ? 1 : 2); k++ )
-            {
-                if( k == 1 )
-                    dataA += cols - 1, dataB += cols - 1, dataC += cols - 1;
-                dataC[0] = saturate_cast<double>(dataA[0] / (dataB[0] + lambda));
-                if( rows % 2 == 0 )
-                    dataC[(rows-1)*stepC] = saturate_cast<double>(dataA[(rows-1)*stepA]/ (dataB[(rows-1)*stepB]+ lambda));
-                if( !conjB )
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        double _a = dataA[j*stepA];
-                        double _b = dataA[(j+1)*stepA];
-                        double _c = dataB[j*stepB];
-                        double _d = dataB[(j+1)*stepB];
-                        double den = (_c + lambda) * (_c + lambda) + (_d * _d);
-                        double re = _a * _c + _b * _d;
-                        double im = _b * _c - _a * _d;
-                        
-                        dataC[j*stepC] = saturate_cast<double>(re/den);
-                        dataC[(j+1)*stepC] = saturate_cast<double>(im/den);
-                    }
-                else
-                    for( j = 1; j <= rows - 2; j += 2 )
-                    {
-                        double _a = dataA[j*stepA];
-                        double _b = dataA[(j+1)*stepA];
-                        double _c = dataB[j*stepB];
-                        double _d = dataB[(j+1)*stepB];
-                        double den = (_c + lambda) * (_c + lambda) + (_d * _d);
-                        double re = _a * _c - _b * _d;
-                        double im = _a * _d + _b * _c;
-                        
-                        dataC[j*stepC] = saturate_cast<double>(re/den);
-                        dataC[(j+1)*stepC] = saturate_cast<double>(im/den);
-                    }
-                if( k == 1 )
-                    dataA -= cols - 1, dataB -= cols - 1, dataC -= cols - 1;
-            }
+            dataC[0] = dataA[0] / (dataB[0] + lambda);
+            if( cols % 2 == 0 )
+                dataC[j1] = dataA[j1] / (dataB[j1] + lambda);
         }
         
-        for( ; rows--; dataA += stepA, dataB += stepB, dataC += stepC )
-        {
-            if( is_1d && cn == 1 )
+        if( !conjB )
+            for( j = j0; j < j1; j += 2 )
             {
-                dataC[0] =saturate_cast<double>( dataA[0]/ (dataB[0]+lambda));
-                if( cols % 2 == 0 )
-                    dataC[j1] =saturate_cast<double>( dataA[j1] / (dataB[j1] + lambda));
+                //Ia = a + bi, Ib = b + ci
+                //Ia/Ib = (a + bi) * ( c - di) / (c^2 + d^2);
+                //den = c^2 + d^2
+                //re = ac + bd / den
+                //im = cb - ad / den
+                double _a = (double)dataA[j];
+                double _b = (double)dataA[j+1];
+                double _c = (double)dataB[j];
+                double _d = (double)dataB[j+1];
+                double den = (_c + lambda) * (_c + lambda) + (_d * _d);
+                double re = _a * _c + _b * _d;
+                double im = _b * _c - _a * _d;
+                
+                dataC[j] = saturate_cast<T>(re/den);
+                dataC[j+1] = saturate_cast<T>(im/den);
+            }
+        else
+            for( j = j0; j < j1; j += 2 )
+            {
+                double _a = (double)dataA[j];
+                double _b = (double)dataA[j+1];
+                double _c = (double)dataB[j];
+                double _d = (double)dataB[j+1];
+                double den = (_c + lambda) * (_c + lambda) + (_d * _d);
+                double re = _a * _c - _b * _d;
+                double im = _a * _d + _b * _c;
+                dataC[j] = saturate_cast<T>(re/den);
+                dataC[j+1] = saturate_cast<T>(im/den);
             }
-            
-            if( !conjB )
-                for( j = j0; j < j1; j += 2 )
-                {
-                    double _a = dataA[j];
-                    double _b = dataA[j+1];
-                    double _c = dataB[j];
-                    double _d = dataB[j+1];
-                    double den = (_c + lambda) * (_c + lambda) + (_d * _d);
-                    double re = _a * _c + _b * _d;
-                    double im = _b * _c - _a * _d;
-                    
-                    dataC[j] = saturate_cast<double>(re/den);
-                    dataC[j+1] =saturate_cast<double>( im/den);
-                    
-                }
-            else
-                for( j = j0; j < j1; j += 2 )
-                {
-                    double _a = dataA[j];
-                    double _b = dataA[j+1];
-                    double _c = dataB[j];
-                    double _d = dataB[j+1];
-                    double den = (_c + lambda) * (_c + lambda) + (_d * _d);
-                    double re = _a * _c - _b * _d;
-                    double im = _a * _d + _b * _c;
-                    dataC[j] = saturate_cast<double>(re/den);
-                    dataC[j+1] = saturate_cast<double>(im/den);
-                }
-        }
     }
 }
 
-
-
-
+void KTrackers::divSpectrums( InputArray _srcA, InputArray _srcB,
+                   OutputArray _dst, int flags, bool conjB  ,double lambda)
+{
+    Mat srcA = _srcA.getMat(), srcB = _srcB.getMat();
+    int depth = srcA.depth(), cn = srcA.channels(), type = srcA.type();
+    
+    CV_Assert( type == srcB.type() && srcA.size() == srcB.size() );
+    CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
+    
+    _dst.create( srcA.rows, srcA.cols, type );
+    Mat dst = _dst.getMat();
+    
+    if( depth == CV_32F )
+    {
+        if( cn == 1 )
+            spectrumDivision<float, 1>(srcA, srcB, dst, flags, conjB, lambda);
+        else
+            spectrumDivision<float, 2>(srcA, srcB, dst, flags, conjB, lambda);
+    }
+    else
+    {
+        if( cn == 1 )
+            spectrumDivision<double, 1>(srcA, srcB, dst, flags, conjB, lambda);
+        else
+            spectrumDivision<double, 2>(srcA, srcB, dst, flags, conjB, lambda);
+    }
+}
+template<bool complex>
+void KTrackers::divSpectrums(const Mat &srcA, const Mat &srcB, Mat &dst, double lambda)
+{
+    //the filter only works with single precision spectrums
+    const int type = complex ? CV_32FC2 : CV_32FC1;
+    CV_Assert( srcA.type() == type && srcB.type() == type && srcA.size() == srcB.size() );
+    dst.create( srcA.rows, srcA.cols, type );
+    spectrumDivision<float, complex ? 2 : 1>(srcA, srcB, dst, 0, false, lambda);
+}
 
 void KTrackers::fastTraining(const Mat &yf,
                          const Mat &kf,
@@ -464,6 +397,15 @@ void KTrackers::fastTraining(const Mat &yf,
     //alphaf = yf ./ (kf + lambda);
     divSpectrums(yf, kf, alphaf, 0, false, params.lambda);
 }
+template<bool complex>
+void KTrackers::fastTraining(const Mat &yf,
+                             const Mat &kf,
+                             const ConfigParams& params,
+                             Mat &alphaf)
+{
+    //alphaf = yf ./ (kf + lambda);
+    divSpectrums<complex>(yf, kf, alphaf, params.lambda);
+}
 
 
 
@@ -471,6 +413,7 @@ void KTrackers::learn(vector<Mat> &modelXf, const vector<Mat> &xf,
                   Mat         &modelAlphaF, const Mat &alphaf,
                   const ConfigParams& params)
 {
+    VIVA_TRACE_SCOPE("sKCF::learn");
     assert(xf.size() == modelXf.size());
     addWeighted(modelAlphaF, (1.0 - params.interp_factor), alphaf,
                 params.interp_factor, 0, modelAlphaF);
@@ -485,9 +428,9 @@ void KTrackers::learn(vector<Mat> &modelXf, const vector<Mat> &xf,
     weightPara(Range(0, xf.size()));
 }
 
-double KTrackers::fastDetection(const Mat &modelAlphaF, const Mat &kzf, Point &maxLoc)
+double KTrackers::fastDetection(const Mat &modelAlphaF, const Mat &kzf, Point &maxLoc, TWorkspace &ws)
 {
-    Mat response, spatial;
+    Mat &response = ws.response, &spatial = ws.spatial;
     mulSpectrums(modelAlphaF, kzf, response, 0, false);
     idft(response, spatial, DFT_SCALE | DFT_REAL_OUTPUT);
     double minVal; double maxVal; Point minLoc;
@@ -663,6 +606,7 @@ void KTrackers::gaussian_shaped_labels(float sigma, const Size &sz, Mat &labels)
 
 void KTrackers::getPatch(const Mat& image,const Point2f &loc, const Size &sz, Mat &output)
 {
+    VIVA_TRACE_SCOPE("sKCF::getPatch");
     Rect iRoi(0,0, image.cols, image.rows);
     Rect tRoi(loc.x - floor(sz.width/2), loc.y - floor(sz.height/2),
               sz.width, sz.height);
@@ -694,6 +638,51 @@ void KTrackers::getPatch(const Mat& image,const Point2f &loc, const Size &sz, Ma
     copyMakeBorder(image(fRoi), output, top, bottom, left, right, BORDER_REPLICATE | BORDER_ISOLATED);
 }
 
+const Mat& KTrackers::cachedHann(const Size &sz,
+                                 const ConfigParams &params,
+                                 TCache &cache)
+{
+    if (cache.size != sz || cache.cellSize != params.cell_size)
+    {
+        //new window size, every entry of the cache is stale
+        cache = TCache();
+        cache.size     = sz;
+        cache.cellSize = params.cell_size;
+    }
+    if (cache.hann.empty())
+        hannWindow(sz, cache.hann);
+    return cache.hann;
+}
+
+void  KTrackers::cachedLabels(const Size &sz,
+                              float sigma,
+                              float sigmaW,
+                              float sigmaH,
+                              const ConfigParams &params,
+                              TCache &cache)
+{
+    if (cache.size != sz || cache.cellSize != params.cell_size)
+    {
+        cache = TCache();
+        cache.size     = sz;
+        cache.cellSize = params.cell_size;
+    }
+    if (cache.gaussian.empty() || cache.sigmaW != sigmaW || cache.sigmaH != sigmaH)
+    {
+        gaussianWindow(sz, sigmaW, sigmaH, cache.gaussian);
+        cache.gaussianF.valid = false;
+        cache.sigmaW = sigmaW;
+        cache.sigmaH = sigmaH;
+    }
+    if (cache.yf.empty() || cache.sigma != sigma)
+    {
+        Mat labels;
+        gaussian_shaped_labels(sigma, sz, labels);
+        fft2(labels, cache.yf, params);
+        cache.sigma = sigma;
+    }
+}
+
 void  KTrackers::hannWindow(const Size &sz, Mat &filter)
 {
     int width = sz.width;
@@ -731,154 +720,322 @@ void KTrackers::fft2(const Mat &features, Mat &fft2, const ConfigParams &params)
 
 void KTrackers::fft2(const vector<Mat> &features, vector<Mat> &fft2, const ConfigParams &params)
 {
-    fft2.clear();
+    if (params.flags == 0)
+        KTrackers::fft2<false>(features, fft2, params);
+    else //DFT_COMPLEX_OUTPUT
+        KTrackers::fft2<true>(features, fft2, params);
+}
+template<bool complex>
+void KTrackers::fft2(const vector<Mat> &features, vector<Mat> &fft2, const ConfigParams &params)
+{
+    VIVA_TRACE_SCOPE("sKCF::fft2");
+    const int flags = complex ? DFT_COMPLEX_OUTPUT : 0;
+    //keeps the spectrums of a previous call, dft reuses their storage
     fft2.resize(features.size());
     auto dftPara = [&](const Range &r) {
         for (size_t i = r.start ; i != r.end; ++i)
         {
-            dft(features[i], fft2[i], params.flags);
+            dft(features[i], fft2[i], flags);
         }
     };
-    dftPara(Range(0,features.size()));
+    size_t work = features.empty() ? 0 : features.size() * features[0].total();
+    parallelChannels(Range(0,features.size()), dftPara, params, work);
 }
 void KTrackers::fft2(vector<Mat> &features, const ConfigParams &params)
 {
+    VIVA_TRACE_SCOPE("sKCF::fft2");
     auto dftPara = [&](const Range &r) {
         for (size_t i = r.start ; i != r.end; ++i)
         {
             dft(features[i], features[i], params.flags);
         }
     };
-    dftPara(Range(0,features.size()));
+    size_t work = features.empty() ? 0 : features.size() * features[0].total();
+    parallelChannels(Range(0,features.size()), dftPara, params, work);
 }
 
 
 
-double KTrackers::sumSpectrum(const Mat &mat, const ConfigParams &params)
+template<bool complex>
+double KTrackers::sumSpectrum(const Mat &mat)
 {
     //CCS packed format only carries half of the info.
     //Top left value is not repeated when the spectrum is expanded
-    if (params.flags == 0)
+    if (complex)
+        return sum(mat).val[0];
+    else
         return (sum(mat).val[0] * 2) - mat.at<float>(0,0);
+}
+double KTrackers::sumSpectrum(const Mat &mat, const ConfigParams &params)
+{
+    if (params.flags == 0)
+        return sumSpectrum<false>(mat);
     else //DFT_COMPLEX_OUTPUT
+        return sumSpectrum<true>(mat);
+}
+template<bool complex>
+void KTrackers::removeMeans(vector<Mat> &xf,
+                            const vector<float> &means,
+                            const Mat &window,
+                            TSpectrum &windowF)
+{
+    //features without mean (FHOG)
+    if (means.empty())
+        return;
+    assert(means.size() == xf.size());
+    if (!windowF.valid)
     {
-        return sum(mat).val[0];
+        dft(window, windowF.spectrum, complex ? DFT_COMPLEX_OUTPUT : 0);
+        windowF.valid = true;
+    }
+    //dft((x - m) .* w) = dft(x .* w) - m * dft(w), in both layouts
+    for (size_t i = 0; i < xf.size(); ++i)
+        scaleAdd(windowF.spectrum, -means[i], xf[i], xf[i]);
+}
+size_t KTrackers::channelBlocks(size_t channels, const ConfigParams &params, size_t work)
+{
+    //one block for every 64K elements, parallel from two blocks on
+    if (!params.parallel || work < (1 << 17))
+        return 1;
+    return std::max<size_t>(1, std::min(channels, work >> 16));
+}
+void KTrackers::parallelChannels(const Range &channels,
+                                 const std::function<void(const Range&)> &body,
+                                 const ConfigParams &params,
+                                 size_t work)
+{
+    size_t blocks = channelBlocks(channels.end - channels.start, params, work);
+    if (blocks == 1)
+        body(channels);
+    else
+        viva::ThreadBudget::parallel(channels, body, blocks);
+}
+void KTrackers::parallelBlocks(const Range &channels,
+                               size_t blocks,
+                               const std::function<void(size_t, const Range&)> &body)
+{
+    int length = channels.end - channels.start;
+    auto run = [&](const Range &b) {
+        for (int k = b.start; k != b.end; ++k)
+            body(k, Range(channels.start + (int)(length * k / blocks),
+                          channels.start + (int)(length * (k + 1) / blocks)));
+    };
+    if (blocks == 1)
+        run(Range(0, 1));
+    else
+        viva::ThreadBudget::parallel(Range(0, (int)blocks), run, blocks);
+}
+template<bool complex>
+double KTrackers::energySpectrum(const Mat &xf)
+{
+    //same value as sumSpectrum(xf .* conj(xf)) without computing the product:
+    //each CCS or complex entry contributes with its squared magnitude.
+    double energy = norm(xf, NORM_L2SQR);
+    if (complex)
+    {
+        return energy;
+    }
+    else //CCS packed format
+    {
+        float dc = xf.at<float>(0,0);
+        return (energy * 2) - dc * dc;
     }
 }
+double KTrackers::energySpectrum(const Mat &xf, const ConfigParams &params)
+{
+    if (params.flags == 0)
+        return energySpectrum<false>(xf);
+    else //DFT_COMPLEX_OUTPUT
+        return energySpectrum<true>(xf);
+}
+void KTrackers::polynomial_correlation(const vector<Mat> &xf,
+                                       const vector<Mat> &yf,
+                                       const ConfigParams &params,
+                                       Mat &kf,
+                                       TWorkspace &ws)
+{
+    if (params.flags == 0)
+        polynomial_correlation<false>(xf, yf, params, kf, ws);
+    else //DFT_COMPLEX_OUTPUT
+        polynomial_correlation<true>(xf, yf, params, kf, ws);
+}
+template<bool complex>
 void KTrackers::polynomial_correlation(const vector<Mat> &xf,
                                        const vector<Mat> &yf,
                                        const ConfigParams &params,
-                                       Mat &kf)
+                                       Mat &kf,
+                                       TWorkspace &ws)
 {
+    VIVA_TRACE_SCOPE("sKCF::polynomial_correlation");
     Size size(xf[0].cols, xf[0].rows);
     double N    = size.width * size.height * xf.size();
-    Mat sumC    = Mat::zeros(size, CV_32FC1);
-    Mutex access;
-    auto fPara = [&](const Range &r){
-        Mat _sumC    = Mat::zeros(size, CV_32FC1);
+    //the dft is linear, the channels are added in the Fourier domain
+    //and transformed back to the spatial domain only once.
+    Mat &sumF   = ws.sumF;
+    size_t blocks = channelBlocks(xf.size(), params, xf.size() * xf[0].total());
+    ws.blockF.resize(blocks);
+    ws.blockResponse.resize(blocks);
+    auto fPara = [&](size_t block, const Range &r){
+        //the first block accumulates straight into the workspace
+        Mat &_sumF    = block == 0 ? sumF : ws.blockF[block];
+        Mat &response = block == 0 ? ws.response : ws.blockResponse[block];
+        _sumF.create(size, xf[0].type());
+        _sumF.setTo(0);
         for (size_t i = r.start; i != r.end; ++i )
         {
-            Mat response, spatial;
             //cross-correlation term in Fourier domain
             mulSpectrums(xf[i], yf[i], response, 0, true);
-            //inverse = real(ifft2(response)) back to spatial domain
-            idft(response, spatial, DFT_SCALE | DFT_REAL_OUTPUT);
-            //sum the values from each channel
-            add(_sumC, spatial, _sumC);
+            //sum the spectrum of each channel
+            add(_sumF, response, _sumF);
         }
-        access.lock();
-        add(sumC, _sumC, sumC);
-        access.unlock();
     };
-    fPara(Range(0,xf.size()));
-    //    NonParallelVersion
+    parallelBlocks(Range(0,xf.size()), blocks, fPara);
+    for (size_t b = 1; b < blocks; ++b)
+        add(sumF, ws.blockF[b], sumF);
+    Mat &sumC = ws.spatial;
+    //inverse = real(ifft2(sum)) back to spatial domain
+    idft(sumF, sumC, DFT_SCALE | DFT_REAL_OUTPUT);
     polynomialResponse<float>(sumC, N, params.kernel_poly_a, params.kernel_poly_b);
-    dft(sumC,kf, params.flags);
+    dft(sumC,kf, complex ? DFT_COMPLEX_OUTPUT : 0);
     
 }
+template<KType kernel, bool complex>
+void KTrackers::correlation(const vector<Mat> &xf,
+                            const vector<Mat> &yf,
+                            const ConfigParams &params,
+                            Mat &kf,
+                            TWorkspace &ws,
+                            bool autocorrelation)
+{
+    //kernel is a constant, only one branch remains after inlining
+    if (kernel == KType::GAUSSIAN)
+        gaussian_correlation<complex>(xf, yf, params, kf, ws, autocorrelation);
+    else if (kernel == KType::POLYNOMIAL)
+        polynomial_correlation<complex>(xf, yf, params, kf, ws);
+    else
+        linear_correlation(xf, yf, params, kf, ws);
+}
+void KTrackers::gaussian_correlation(const vector<Mat> &xf,
+                                     const vector<Mat> &yf,
+                                     const ConfigParams &params,
+                                     Mat &kf,
+                                     TWorkspace &ws,
+                                     bool autocorrelation)
+{
+    if (params.flags == 0)
+        gaussian_correlation<false>(xf, yf, params, kf, ws, autocorrelation);
+    else //DFT_COMPLEX_OUTPUT
+        gaussian_correlation<true>(xf, yf, params, kf, ws, autocorrelation);
+}
+template<bool complex>
 void KTrackers::gaussian_correlation(const vector<Mat> &xf,
                                      const vector<Mat> &yf,
                                      const ConfigParams &params,
                                      Mat &kf,
+                                     TWorkspace &ws,
                                      bool autocorrelation)
 {
+    VIVA_TRACE_SCOPE("sKCF::gaussian_correlation");
     double xx   = 0, yy = 0;
     kf.create(xf[0].rows, xf[0].cols, xf[0].type()); //Mat::zeros(xf[0].rows, xf[0].cols, xf[0].type());
-    Mat sumReal = Mat::zeros(xf[0].rows, xf[0].cols, CV_32FC1);
+    //the dft is linear, the channels are added in the Fourier domain
+    //and transformed back to the spatial domain only once.
+    Mat &sumF   = ws.sumF;
     long N      = xf[0].rows * xf[0].cols;
     
+    size_t blocks = channelBlocks(xf.size(), params, xf.size() * xf[0].total());
+    vector<double> blockXX(blocks, 0), blockYY(blocks, 0);
+    ws.blockF.resize(blocks);
+    ws.blockResponse.resize(blocks);
     //speeding up the process when autocorrelation
-    Mutex access;
-    auto fPara = [&](const Range &r) {
+    auto fPara = [&](size_t block, const Range &r) {
         double _xx = 0, _yy = 0;
-        Mat _sumReal = Mat::zeros(xf[0].rows, xf[0].cols, CV_32FC1);
+        //the first block accumulates straight into the workspace
+        Mat &_sumF    = block == 0 ? sumF : ws.blockF[block];
+        Mat &response = block == 0 ? ws.response : ws.blockResponse[block];
+        _sumF.create(xf[0].rows, xf[0].cols, xf[0].type());
+        _sumF.setTo(0);
         for (size_t i = r.start; i != r.end; ++i)
         {
-            Mat response, spatial;
-            //squared norm of x and y
-            mulSpectrums(xf[i], xf[i], response, 0, true);
-            _xx += sumSpectrum(response, params); //cv::sum(response).val[0];
+            //squared norm of x and y, in the same pass as the cross term
+            _xx += energySpectrum<complex>(xf[i]);
             if (!autocorrelation)
             {
-                mulSpectrums(yf[i], yf[i], response, 0, true);
-                _yy += sumSpectrum(response, params); //cv::sum(response).val[0];
+                _yy += energySpectrum<complex>(yf[i]);
                 //cross-correlation term in Fourier domain
                 //response = xf .* conf(yf)
                 mulSpectrums(xf[i], yf[i], response, 0, true);
             }
             else
-                // response and yy are already computed
-                _yy = _xx;
-            //inverse = real(ifft2(response)) back to spatial domain
-            idft(response, spatial, DFT_SCALE | DFT_REAL_OUTPUT);
-            //sum the values from each channel
-            add(_sumReal, spatial, _sumReal);
+            {
+                // response = xf .* conj(xf) and yy = xx
+                mulSpectrums(xf[i], xf[i], response, 0, true);
+            }
+            //sum the spectrum of each channel
+            add(_sumF, response, _sumF);
         }
-        access.lock();
-        xx = _xx;
-        yy = _yy;
-        add(sumReal,_sumReal,sumReal);
-        access.unlock();
+        blockXX[block] = _xx;
+        blockYY[block] = _yy;
     };
 
     
-    fPara(Range(0,xf.size()));
+    parallelBlocks(Range(0,xf.size()), blocks, fPara);
+    //partials merged in block order, the sums do not depend on the threads
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        xx += blockXX[b];
+        yy += blockYY[b];
+        if (b > 0)
+            add(sumF, ws.blockF[b], sumF);
+    }
+    if (autocorrelation)
+        yy = xx;
     xx /= N; // meanX
     yy /= N; // meanY
     
+    //inverse = real(ifft2(sum)) back to spatial domain
+    Mat &sumReal = ws.spatial;
+    idft(sumF, sumReal, DFT_SCALE | DFT_REAL_OUTPUT);
+    
     double a = -1 / (params.kernel_sigma * params.kernel_sigma);
     double b = xx + yy;
     double c = (double)N * xf.size();
     
     gaussianResponse<float>(sumReal, a,  b, c);
-    dft(sumReal, kf, params.flags);
+    dft(sumReal, kf, complex ? DFT_COMPLEX_OUTPUT : 0);
 }
 
 
 void KTrackers::linear_correlation(const vector<Mat> &xf,
                                    const vector<Mat> &yf,
-                                   Mat &kf)
+                                   const ConfigParams &params,
+                                   Mat &kf,
+                                   TWorkspace &ws)
 {
+    VIVA_TRACE_SCOPE("sKCF::linear_correlation");
     Size size(xf[0].cols, xf[0].rows);
     double N    = size.width * size.height * xf.size();
-    kf = Mat::zeros(size, xf[0].type());
-    Mutex access;
-    auto fPara = [&](const Range &r){
-        Mat _kf = Mat::zeros(size, xf[0].type());
+    size_t blocks = channelBlocks(xf.size(), params, xf.size() * xf[0].total());
+    ws.blockF.resize(blocks);
+    ws.blockResponse.resize(blocks);
+    auto fPara = [&](size_t block, const Range &r){
+        //the first block accumulates straight into kf
+        Mat &_kf      = block == 0 ? kf : ws.blockF[block];
+        Mat &response = block == 0 ? ws.response : ws.blockResponse[block];
+        _kf.create(size, xf[0].type());
+        _kf.setTo(0);
         for (size_t i = r.start; i != r.end; ++i )
         {
-            Mat response;
             //cross-correlation term in Fourier domain
             mulSpectrums(xf[i], yf[i], response, 0, true);
             add(_kf, response, _kf);
 
         }
-        access.lock();
-        add(kf, _kf, kf);
-        access.unlock();
     };
-    fPara(Range(0,xf.size()));
-    kf = kf / N;
+    parallelBlocks(Range(0,xf.size()), blocks, fPara);
+    for (size_t b = 1; b < blocks; ++b)
+        add(kf, ws.blockF[b], kf);
+    kf *= 1.0 / N;
     
 }
 
@@ -903,69 +1060,225 @@ void rgbNorm(Mat &input, Mat &output)
 }
 
 
+//B*0.114 + G*0.587 + R*0.299 rounded as CV_BGR2GRAY
+static inline int grayValue(const uchar *bgr)
+{
+    return (bgr[0] * 1868 + bgr[1] * 9617 + bgr[2] * 4899 + (1 << 13)) >> 14;
+}
+
+/*
+ * Planar features of an 8 bit patch of cn channels in one pass over the
+ * pixels: scale to [0,1], optional BGR to gray (same fixed point weights
+ * as cvtColor) and window, four pixels per SSE step. The channel means
+ * are accumulated in the same pass and returned instead of subtracted:
+ * removeMeans takes them out of the spectrums, which is exact because
+ * dft((x - m) .* w) = dft(x .* w) - m * dft(w).
+ */
+template<int cn, bool gray>
+static void planarFeatures(const Mat &patch,
+                           const Mat &window,
+                           vector<Mat> &features,
+                           vector<float> &means)
+{
+    const int channels = gray ? 1 : cn;
+    const float scale  = 1.0f / 255.0f;
+    const int   rows   = patch.rows, cols = patch.cols;
+    const __m128 _scale = SET(scale);
+    assert(patch.depth() == CV_8U && patch.channels() == cn);
+    assert(window.size() == patch.size() && window.type() == CV_32FC1);
+    
+    features.resize(channels);
+    for (int c = 0; c < channels; ++c)
+        features[c].create(patch.size(), CV_32FC1);
+    
+    double sums[cn] = {0};
+    for (int r = 0; r < rows; ++r)
+    {
+        const uchar *src = patch.ptr<uchar>(r);
+        const float *w   = window.ptr<float>(r);
+        float *dst[cn];
+        __m128 _sums[cn];
+        for (int c = 0; c < channels; ++c)
+        {
+            dst[c]   = features[c].ptr<float>(r);
+            _sums[c] = SET(0.f);
+        }
+        
+        int x = 0;
+        for (; x <= cols - 4; x += 4, src += 4 * cn)
+        {
+            __m128 _w = LDu(w[x]);
+            for (int c = 0; c < channels; ++c)
+            {
+                __m128i _v = gray ?
+                    _mm_set_epi32(grayValue(src + 3 * cn), grayValue(src + 2 * cn),
+                                  grayValue(src + cn),     grayValue(src)) :
+                    _mm_set_epi32(src[3 * cn + c], src[2 * cn + c],
+                                  src[cn + c],     src[c]);
+                __m128 _f = MUL(CVT(_v), _scale);
+                _sums[c]  = ADD(_sums[c], _f);
+                STRu(dst[c][x], MUL(_f, _w));
+            }
+        }
+        
+        float rowSums[cn] = {0};
+        for (; x < cols; ++x, src += cn)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                float f = (gray ? grayValue(src) : src[c]) * scale;
+                rowSums[c] += f;
+                dst[c][x]   = f * w[x];
+            }
+        }
+        for (int c = 0; c < channels; ++c)
+        {
+            float lanes[4];
+            STRu(lanes[0], _sums[c]);
+            sums[c] += rowSums[c] + ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]));
+        }
+    }
+    
+    const double total = (double)rows * cols;
+    means.resize(channels);
+    for (int c = 0; c < channels; ++c)
+        means[c] = sums[c] / total;
+}
+
+template<>
+void KTrackers::extractFeatures<KFeat::HSV>(const Mat& patch,
+                                            const ConfigParams &params,
+                                            const Mat& windowFunction,
+                                            vector<Mat> &features,
+                                            TWorkspace &ws)
+{
+    Mat &color    = ws.color;
+    KFlow::toBGR(patch, color);
+
+    cvtColor(color, color, CV_BGR2HSV_FULL);
+    //range of HSV_FULL is 0-255 0-255 0-255
+    //range of HSV      is 0-180 0-255 0-255
+
+    planarFeatures<KFeatTraits<KFeat::HSV>::count, false>(color, windowFunction, features, ws.means);
+}
+
+template<>
+void KTrackers::extractFeatures<KFeat::HLS>(const Mat& patch,
+                                            const ConfigParams &params,
+                                            const Mat& windowFunction,
+                                            vector<Mat> &features,
+                                            TWorkspace &ws)
+{
+    Mat &color    = ws.color;
+    KFlow::toBGR(patch, color);
+    //range of HLS_FULL is 0-255 0-255 0-255
+    //range of HLS      is 0-180 0-255 0-255
+    cvtColor(color, color, CV_BGR2HLS_FULL);
+    planarFeatures<KFeatTraits<KFeat::HLS>::count, false>(color, windowFunction, features, ws.means);
+}
+
+template<>
+void KTrackers::extractFeatures<KFeat::GRAY>(const Mat& patch,
+                                             const ConfigParams &params,
+                                             const Mat& windowFunction,
+                                             vector<Mat> &features,
+                                             TWorkspace &ws)
+{
+    static_assert(KFeatTraits<KFeat::GRAY>::count == 1, "gray features are one channel");
+    if (patch.channels() == 1)
+        planarFeatures<1, false>(patch, windowFunction, features, ws.means);
+    else
+        planarFeatures<3, true>(patch, windowFunction, features, ws.means);
+}
+
+template<>
+void KTrackers::extractFeatures<KFeat::RGB>(const Mat& patch,
+                                            const ConfigParams &params,
+                                            const Mat& windowFunction,
+                                            vector<Mat> &features,
+                                            TWorkspace &ws)
+{
+    //a gray patch keeps its single channel, as the original RGB features
+    const int cn = KFeatTraits<KFeat::RGB>::count;
+    if (patch.channels() == cn)
+        planarFeatures<cn, false>(patch, windowFunction, features, ws.means);
+    else
+        planarFeatures<1, false>(patch, windowFunction, features, ws.means);
+}
+
+template<>
+void KTrackers::extractFeatures<KFeat::FHOG>(const Mat& patch,
+                                             const ConfigParams &params,
+                                             const Mat& windowFunction,
+                                             vector<Mat> &features,
+                                             TWorkspace &ws)
+{
+    Mat &color    = ws.color;
+    Mat &floatImg = ws.floatImg;
+    KFlow::toGray(patch, color);
+    color.convertTo(floatImg, CV_32F, 1.0/255.0);
+    fhog(floatImg, ws.hog, params.cell_size, params.hog_orientations, ws.hogBuffer);
+    //the descriptor is not centered
+    ws.means.clear();
+    //last channel is only zeros, features share the data of the others
+    features.assign(ws.hog.begin(), ws.hog.end() - 1);
+    
+    const int channels = KFeatTraits<KFeat::FHOG>::channels(params);
+    assert(features.size() == (size_t)channels);
+    auto fPara = [&](const Range &r){
+        for( int i = r.start; i != r.end; ++i)
+        {
+            multiply(features[i], windowFunction, features[i]);
+
+        }
+    };
+    parallelChannels(Range(0,channels), fPara, params, channels * windowFunction.total());
+}
+
+template<KFeat feature>
+void KTrackers::getFeatures(const Mat& patch,
+                            const ConfigParams &params,
+                            const Mat& windowFunction,
+                            vector<Mat> &features,
+                            TWorkspace &ws)
+{
+    VIVA_TRACE_SCOPE("sKCF::getFeatures");
+    //the channels and the intermediate images keep their storage
+    //between calls, every step writes into them in place
+    extractFeatures<feature>(patch, params, windowFunction, features, ws);
+}
+
 void KTrackers::getFeatures(const Mat& patch,
                         const ConfigParams &params,
                         const Mat& windowFunction,
-                        vector<Mat> &features)
+                        vector<Mat> &features,
+                        TWorkspace &ws)
 {
-    features.clear();
-    
-    
     //assert(patch.type() == CV_32F || patch.type() == CV_32FC3);
     switch (params.kernel_feature) {
         case (KFeat::HSV):
         {
-            Mat color, hsv, floatImg;
-            KFlow::toBGR(patch, color);
-
-            cvtColor(color, hsv, CV_BGR2HSV_FULL);
-            //range of HSV_FULL is 0-255 0-255 0-255
-            //range of HSV      is 0-180 0-255 0-255
-
-            hsv.convertTo(floatImg, CV_32F, 1.0/255.0);
-            Scalar _mean = mean(floatImg);
-            split(floatImg - _mean, features);
-
-            
+            getFeatures<KFeat::HSV>(patch, params, windowFunction, features, ws);
             break;
         }
         case (KFeat::HLS):
         {
-            Mat color, hsv, floatImg;
-            KFlow::toBGR(patch, color);
-            //range of HLS_FULL is 0-255 0-255 0-255
-            //range of HLS      is 0-180 0-255 0-255
-            cvtColor(color, hsv, CV_BGR2HLS_FULL);
-            hsv.convertTo(floatImg, CV_32F, 1.0/255.0);
-            Scalar _mean = mean(floatImg);
-            split(floatImg - _mean, features);
+            getFeatures<KFeat::HLS>(patch, params, windowFunction, features, ws);
             break;
         }
         case (KFeat::GRAY):
         {
-            Mat grayImg, floatImg;
-            KFlow::toGray(patch, grayImg);
-            grayImg.convertTo(floatImg, CV_32F, 1.0/255.0);
-            Scalar _mean = mean(floatImg);
-            split(floatImg - _mean, features);
+            getFeatures<KFeat::GRAY>(patch, params, windowFunction, features, ws);
             break;
         }
         case (KFeat::RGB):
         {
-            Mat floatImg;
-            patch.convertTo(floatImg, CV_32F, 1.0/255.0);
-            Scalar _mean = mean(floatImg);
-            split(floatImg - _mean, features);
-            
+            getFeatures<KFeat::RGB>(patch, params, windowFunction, features, ws);
             break;
         }
         case (KFeat::FHOG):
         {
-            Mat grayImg, floatImg;
-            KFlow::toGray(patch, grayImg);
-            grayImg.convertTo(floatImg, CV_32F, 1.0/255.0);
-            fhog(floatImg, features, params.cell_size, params.hog_orientations);
-            features.pop_back(); //last channel is only zeros
+            getFeatures<KFeat::FHOG>(patch, params, windowFunction, features, ws);
             break;
         }
         default:
@@ -973,21 +1286,182 @@ void KTrackers::getFeatures(const Mat& patch,
             break;
         }
     }
-    auto fPara = [&](const Range &r){
-        for( size_t i = r.start; i != r.end; ++i)
-        {
-            features[i] = features[i].mul(windowFunction);
-
-        }
-    };
-    fPara(Range(0,features.size()));
-    //return features[0].size();
 }
 
 
 /*
  * Computes the NCC value for points from one frame to the other
  */
+void KFlow::setReference(const Mat &frame)
+{
+    toGray(frame, _curr);
+    //the pyramid of the new reference is built once for the next frame
+    buildOpticalFlowPyramid(_curr, _currPyr, _params.winLK, _params.level);
+    hannTables(_curr.size());
+}
+
+void KFlow::hannTables(const Size &size)
+{
+    if (size == _hannSize)
+        return;
+    _hannSize = size;
+    _hannW.resize(size.width);
+    _hannH.resize(size.height);
+    for (int i = 0; i < size.width; ++i )
+        _hannW[i] = .5 * ( 1. - cos((2.* CV_PI* i)/(size.width - 1)));
+    for (int i = 0; i < size.height; ++i)
+        _hannH[i] = .5 * ( 1. - cos((2.* CV_PI* i)/(size.height- 1)));
+}
+
+Rect KFlow::targetBox(const Size2d &size) const
+{
+    Point tl(max(0.0,_hannSize.width/2.0  - floor(size.width/2.0)),
+             max(0.0,_hannSize.height/2.0 - floor(size.height/2.0)));
+    Point br(tl + Point(floor(size.width), floor(size.height)));
+    return Rect(tl, br);
+}
+
+void KFlow::samplePoints(const Rect &box, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        double nX = _rng.uniform((double)box.x, (double)(box.x + box.width));
+        double nY = _rng.uniform((double)box.y, (double)(box.y + box.height));
+        Point2f pt(nX, nY);
+        float _weight = weight(pt);
+        if (_weight < _params.minWeight) continue;
+        
+        _weights.push_back(_weight);
+        _pts.push_back(pt);
+    }
+}
+
+void KFlow::extractPoints(const Mat &frame,
+                          const Size2d size)
+{
+    VIVA_TRACE_SCOPE("KFlow::extractPoints");
+    setReference(frame);
+    assert(_curr.type() == CV_8UC1);
+    
+    Rect box = targetBox(size);
+    Mat mask = Mat::zeros(_curr.size(),CV_8UC1);
+    rectangle(mask, box.tl(), box.br(), Scalar(255), CV_FILLED);
+    vector<Point2f> corners;
+    goodFeaturesToTrack(_curr,
+                        corners,
+                        _params.maxCorners,
+                        _params.qualityLevel,
+                        _params.minDistance,
+                        mask,
+                        _params.blockSize,
+                        _params.useHarrisDetector,
+                        _params.k);
+    _weights.clear();
+    _pts.clear();
+    _tracked.clear();
+    
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        float _weight = weight(corners[i]);
+        if (_weight < _params.minWeight) continue;
+        _weights.push_back(_weight);
+        _pts.push_back(corners[i]);
+    }
+    //every full extraction draws the same samples
+    _rng = RNG(0xFFFFFFFF);
+    samplePoints(box, _params.randomPoints);
+    
+    _frames   = 0;
+    _detected = _pts.size();
+}
+
+void KFlow::updatePoints(const Mat &frame,
+                         const Size2d size)
+{
+    if (_tracked.empty() || ++_frames >= _params.redetectFrames ||
+        _tracked.size() < _checked * _params.minSurvival)
+    {
+        extractPoints(frame, size);
+        return;
+    }
+    
+    VIVA_TRACE_SCOPE("KFlow::updatePoints");
+    setReference(frame);
+    Rect box = targetBox(size);
+    int cells = max(1, _params.gridCells);
+    if (box.width < cells || box.height < cells)
+    {
+        extractPoints(frame, size);
+        return;
+    }
+    
+    //survivors still on the target, counted per cell of the grid
+    vector<int> coverage(cells * cells, 0);
+    Rect_<float> area(box);
+    _pts.clear();
+    _weights.clear();
+    for (size_t i = 0; i < _tracked.size(); i++)
+    {
+        const Point2f &pt = _tracked[i];
+        if (!area.contains(pt)) continue;
+        float _weight = weight(pt);
+        if (_weight < _params.minWeight) continue;
+        _weights.push_back(_weight);
+        _pts.push_back(pt);
+        
+        int cx = min(cells - 1, (int)((pt.x - box.x) * cells / box.width));
+        int cy = min(cells - 1, (int)((pt.y - box.y) * cells / box.height));
+        coverage[cy * cells + cx]++;
+    }
+    _tracked.clear();
+    
+    //cells under the density of the last full extraction get new samples
+    int perCell = max<int>(1, _detected / (cells * cells));
+    for (int cy = 0; cy < cells; cy++)
+    {
+        for (int cx = 0; cx < cells; cx++)
+        {
+            int missing = perCell - coverage[cy * cells + cx];
+            if (missing <= 0) continue;
+            Rect cell(box.x + cx * box.width  / cells,
+                      box.y + cy * box.height / cells,
+                      box.width / cells,
+                      box.height / cells);
+            samplePoints(cell, missing);
+        }
+    }
+}
+
+/*
+ * Bilinear sample of the w x h patch centered at c, as getRectSubPix
+ * (replicated border), without rounding to 8 bits.
+ */
+static inline void samplePatch(const Mat &image,
+                               const Point2f &c,
+                               int w, int h,
+                               float *dst)
+{
+    float x0 = c.x - (w - 1) * 0.5f;
+    float y0 = c.y - (h - 1) * 0.5f;
+    int   ix = cvFloor(x0), iy = cvFloor(y0);
+    float ax = x0 - ix,     ay = y0 - iy;
+    int maxX = image.cols - 1, maxY = image.rows - 1;
+    
+    for (int r = 0; r < h; ++r)
+    {
+        const uchar *p0 = image.ptr<uchar>(min(max(iy + r,     0), maxY));
+        const uchar *p1 = image.ptr<uchar>(min(max(iy + r + 1, 0), maxY));
+        for (int k = 0; k < w; ++k)
+        {
+            int x  = min(max(ix + k,     0), maxX);
+            int x1 = min(max(ix + k + 1, 0), maxX);
+            float top    = p0[x] + ax * (p0[x1] - p0[x]);
+            float bottom = p1[x] + ax * (p1[x1] - p1[x]);
+            dst[r * w + k] = top + ay * (bottom - top);
+        }
+    }
+}
+
 void KFlow::NCC(const Mat &I,
                const Mat &J,
                vector<Point2f> &ptsI,
@@ -997,22 +1471,85 @@ void KFlow::NCC(const Mat &I,
                const KFlowConfigParams &p)
 {
     Size patchSize(p.winsize_ncc, p.winsize_ncc);
-    Mat recI(patchSize, CV_8UC1);
-    Mat recJ(patchSize, CV_8UC1);
-    vector<float> res;
+    bool centered = (p.method == CV_TM_CCOEFF_NORMED);
+    if (!centered && p.method != CV_TM_CCORR_NORMED)
+    {
+        //other scores keep the per point template matching
+        Mat recI(patchSize, CV_8UC1);
+        Mat recJ(patchSize, CV_8UC1);
+        vector<float> res;
+        
+        for (size_t i = 0; i < ptsI.size(); i++)
+        {
+            if (status[i])
+            {
+                getRectSubPix(I, patchSize, ptsI[i], recI);
+                getRectSubPix(J, patchSize, ptsJ[i], recJ);
+                matchTemplate(recI, recJ, res, p.method);
+                result[i] = res[0];
+            }
+            else
+                result[i] = 0.0f;
+        }
+        return;
+    }
     
+    //all the patches are sampled first, then scored in one SSE pass
+    int area   = patchSize.area();
+    int stride = (area + 3) & ~3;
+    vector<size_t> index;
+    index.reserve(ptsI.size());
     for (size_t i = 0; i < ptsI.size(); i++)
     {
+        result[i] = 0.0f;
         if (status[i])
+            index.push_back(i);
+    }
+    
+    float *bufI = (float*) alMalloc(index.size() * stride * sizeof(float), 16);
+    float *bufJ = (float*) alMalloc(index.size() * stride * sizeof(float), 16);
+    for (size_t n = 0; n < index.size(); n++)
+    {
+        float *a = bufI + n * stride, *b = bufJ + n * stride;
+        samplePatch(I, ptsI[index[n]], patchSize.width, patchSize.height, a);
+        samplePatch(J, ptsJ[index[n]], patchSize.width, patchSize.height, b);
+        //zero padding does not change any of the sums
+        fill(a + area, a + stride, 0.0f);
+        fill(b + area, b + stride, 0.0f);
+    }
+    
+    for (size_t n = 0; n < index.size(); n++)
+    {
+        const float *a = bufI + n * stride, *b = bufJ + n * stride;
+        __m128 sA = SET(0.0f), sB = SET(0.0f), sAB = SET(0.0f), sAA = SET(0.0f), sBB = SET(0.0f);
+        for (int k = 0; k < stride; k += 4)
         {
-            getRectSubPix(I, patchSize, ptsI[i], recI);
-            getRectSubPix(J, patchSize, ptsJ[i], recJ);
-            matchTemplate(recI, recJ, res, p.method);
-            result[i] = res[0];
+            __m128 va = LD(a[k]), vb = LD(b[k]);
+            INC(sA, va);
+            INC(sB, vb);
+            INC(sAB, MUL(va, vb));
+            INC(sAA, MUL(va, va));
+            INC(sBB, MUL(vb, vb));
         }
-        else
-            result[i] = 0.0f;
+        float v[5][4];
+        STRu(v[0][0], sA);  STRu(v[1][0], sB); STRu(v[2][0], sAB);
+        STRu(v[3][0], sAA); STRu(v[4][0], sBB);
+        double sum[5];
+        for (int j = 0; j < 5; j++)
+            sum[j] = (double)v[j][0] + v[j][1] + v[j][2] + v[j][3];
+        
+        double ab = sum[2], aa = sum[3], bb = sum[4];
+        if (centered)
+        {
+            ab -= sum[0] * sum[1] / area;
+            aa -= sum[0] * sum[0] / area;
+            bb -= sum[1] * sum[1] / area;
+        }
+        double den = sqrt(aa * bb);
+        result[index[n]] = (den > DBL_EPSILON) ? (float)(ab / den) : 0.0f;
     }
+    alFree(bufI);
+    alFree(bufJ);
 }
 
 /*
@@ -1082,12 +1619,28 @@ void KFlow::flowForwardBackward(const Mat &I,
                                vector<Point2f> &to,
                                const KFlowConfigParams &p)
 {
+    vector<Mat> pyrI, pyrJ;
+    buildOpticalFlowPyramid(I, pyrI, p.winLK, p.level);
+    buildOpticalFlowPyramid(J, pyrJ, p.winLK, p.level);
+    flowForwardBackward(pyrI, pyrJ, I, J, from, to, p);
+}
+
+void KFlow::flowForwardBackward(const vector<Mat> &pyrI,
+                               const vector<Mat> &pyrJ,
+                               const Mat &I,
+                               const Mat &J,
+                               vector<Point2f> &from,
+                               vector<Point2f> &to,
+                               const KFlowConfigParams &p)
+{
+    VIVA_TRACE_SCOPE("KFlow::flowForwardBackward");
     vector<Point2f> points;
     vector<uchar>   accept[2];
     vector<float>      err[2]; //valuesNCC err[0]  //errorFB err[1]
     
-    calcOpticalFlowPyrLK(I, J, from, to, accept[0], err[0], p.winLK, p.level, p.criteria);//CV_LKFLOW_INITIAL_GUESSES);
-    calcOpticalFlowPyrLK(J, I, to, points, accept[1], err[1], p.winLK, p.level, p.criteria);//CV_LKFLOW_INITIAL_GUESSES | CV_LKFLOW_PYR_A_READY | CV_LKFLOW_PYR_B_READY);
+    //both passes reuse the prebuilt pyramids (and their derivatives)
+    calcOpticalFlowPyrLK(pyrI, pyrJ, from, to, accept[0], err[0], p.winLK, p.level, p.criteria);//CV_LKFLOW_INITIAL_GUESSES);
+    calcOpticalFlowPyrLK(pyrJ, pyrI, to, points, accept[1], err[1], p.winLK, p.level, p.criteria);//CV_LKFLOW_INITIAL_GUESSES | CV_LKFLOW_PYR_A_READY | CV_LKFLOW_PYR_B_READY);
     
     for (size_t i = 0; i < from.size(); i++)
     {
@@ -1222,11 +1775,67 @@ void KFlow::transform(Rect_<float> &B,
  *  Transform rectangular region B into BNew using the matching points
  *  from start to tracked.
  */
+/*
+ * Visits the point pairs (i < j) used by the scale estimation. All of them
+ * while there are at most maxPairs, otherwise maxPairs pairs drawn with a
+ * fixed seed, so the cost stops growing with the square of the points.
+ */
+template<typename Visitor>
+static void scalePairs(int n, int maxPairs, Visitor visit)
+{
+    long pairs = (long)n * (n - 1) / 2;
+    if (pairs <= maxPairs)
+    {
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                visit(i, j);
+        return;
+    }
+    RNG rng(0x5CA1E);
+    for (int k = 0; k < maxPairs; k++)
+    {
+        int i = rng.uniform(0, n);
+        int j = rng.uniform(0, n - 1);
+        if (j >= i)
+            j++;
+        visit(min(i, j), max(i, j));
+    }
+}
+
+/*
+ * Ratio between the distances of the pair after and before tracking.
+ * Returns false for coincident start points.
+ */
+static inline bool pairScale(const vector<Point2f> &start,
+                             const vector<Point2f> &tracked,
+                             int i, int j, float &ratio)
+{
+    Point2f diffST = start[i] - start[j];
+    Point2f diffTS = tracked[i] - tracked[j];
+    float dST = diffST.x * diffST.x + diffST.y * diffST.y;
+    float dTS = diffTS.x * diffTS.x + diffTS.y * diffTS.y;
+    if (dST <= 0)
+        return false;
+    ratio = sqrt(dTS / dST);
+    return true;
+}
+
+/*
+ * Lower median, same element as getMedianUnmanaged
+ */
+static inline float lowerMedian(vector<float> &values)
+{
+    vector<float>::iterator m = values.begin() + (values.size() - 1) / 2;
+    nth_element(values.begin(), m, values.end());
+    return *m;
+}
+
 double KFlow::transform(const vector<Point2f> &start,
                        const vector<Point2f> &tracked,
                        Point2f &shift,
                        const KFlowConfigParams &p)
 {
+    VIVA_TRACE_SCOPE("KFlow::transform");
     float fDx = 0, fDy = 0;
     int pStart = 0, size = start.size();
     switch (p.transMode)
@@ -1268,22 +1877,15 @@ double KFlow::transform(const vector<Point2f> &start,
     
     
     vector<float> scales;
-    
-    for (int i = pStart; i < (pStart+ size); i++)
+    scales.reserve(min((long)p.maxScalePairs, (long)size * (size - 1) / 2));
+    scalePairs(size, p.maxScalePairs, [&](int i, int j)
     {
-        for (int j = i + 1; j < (pStart+ size); j++)
-        {
-            Point2f diffST = start[i] - start[j];
-            Point2f diffTS = tracked[i] - tracked[j];
-            float dST = norm(diffST);
-            float dTS = norm(diffTS);
-            
-            scales.push_back(dTS/dST);
-        }
-    }
+        float ratio;
+        if (pairScale(start, tracked, i, j, ratio))
+            scales.push_back(ratio);
+    });
     
-    float fSc = (scales.size() > 0)?
-    getMedianUnmanaged(&scales[0],(int)scales.size()): 1.f;
+    float fSc = (scales.size() > 0)? lowerMedian(scales): 1.f;
     
     shift = Point2f(fDx, fDy);
     return fSc;
@@ -1298,32 +1900,26 @@ double KFlow::transform(const vector<Point2f> &start,
                         const vector<float> &weights,
                         const KFlowConfigParams &p)
 {
-    int pStart = 0, size = start.size();
+    VIVA_TRACE_SCOPE("KFlow::transform");
+    int size = start.size();
     
     double weightedSum = 0;
     double sumOfWeights = 0;
     vector<float> scales;
-    for (int i = pStart; i < (pStart+ size); i++)
+    scales.reserve(min((long)p.maxScalePairs, (long)size * (size - 1) / 2));
+    scalePairs(size, p.maxScalePairs, [&](int i, int j)
     {
+        float ratio;
+        if (!pairScale(start, tracked, i, j, ratio))
+            return;
         float w = weights[i];
-        
-        for (int j = i + 1; j < (pStart+ size); j++)
-        {
-            Point2f diffST = start[i] - start[j];
-            Point2f diffTS = tracked[i] - tracked[j];
-            float dST = norm(diffST);
-            float dTS = norm(diffTS);
-            
-            double ratio = dTS/dST;
-            scales.push_back(ratio);
-            weightedSum += (w*(ratio));
-            sumOfWeights+= w;
-        }
-    }
+        scales.push_back(ratio);
+        weightedSum += (w*(ratio));
+        sumOfWeights+= w;
+    });
     
     float fSc = (sumOfWeights > 0)? weightedSum/sumOfWeights :1.f;
-    float fSc2 = (scales.size() > 0)?
-          getMedianUnmanaged(&scales[0],(int)scales.size()): 1.f;
+    float fSc2 = (scales.size() > 0)? lowerMedian(scales): 1.f;
     
     return (fSc + fSc2)/2;
 }
@@ -1478,3 +2074,162 @@ float KFlow::getMedian(float arr[], int n)
     return median;
 }
 
+void KScale::initialize(const Size2d &size)
+{
+    int n = _params.scales;
+    //limits of the accumulated scale, the target keeps at least min_side pixels
+    _initialSize = size;
+    _minFactor   = max((double)_params.min_factor,
+                       _params.min_side / min(size.width, size.height));
+    _maxFactor   = max(_minFactor, (double)_params.max_factor);
+    //the target is resampled to an area of at most max_area pixels
+    double area   = size.width * size.height;
+    double factor = (area > _params.max_area) ? sqrt(_params.max_area / area) : 1.0;
+    _modelSize = Size(max(2 * _params.cell_size, (int)floor(size.width  * factor)),
+                      max(2 * _params.cell_size, (int)floor(size.height * factor)));
+    
+    //labels peak at the sample of the current scale
+    int   center = (n - 1) / 2;
+    float sigma  = sqrt((float)n) * _params.sigma_factor;
+    float w      = -0.5 / (sigma * sigma);
+    Mat ys(1, n, CV_32FC1);
+    _factors.resize(n);
+    _window.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        float ss    = i - center;
+        ys.at<float>(0, i) = exp(w * ss * ss);
+        _factors[i] = pow(_params.step, center - i);
+        _window[i]  = 0.5 * (1 - cos(2 * CV_PI * (i + 1) / (n + 1)));
+    }
+    dft(ys, _ysf, DFT_ROWS | DFT_COMPLEX_OUTPUT);
+}
+
+void KScale::getSamples(const Mat &frame,
+                        const Point2f &center,
+                        const Size2d &size)
+{
+    VIVA_TRACE_SCOPE("KScale::getSamples");
+    int n = _params.scales;
+    for (int i = 0; i < n; ++i)
+    {
+        Size sz(max(2, (int)floor(size.width  * _factors[i])),
+                max(2, (int)floor(size.height * _factors[i])));
+        //replicates the border when the sample leaves the frame
+        getRectSubPix(frame, sz, center, _patch);
+        resize(_patch, _resized, _modelSize, 0, 0, INTER_LINEAR);
+        KFlow::toGray(_resized, _gray);
+        _gray.convertTo(_floatImg, CV_32F, 1.0/255.0);
+        fhog(_floatImg, _hog, _params.cell_size, _params.orientations, _hogBuffer);
+        
+        Mat features = _hog.reshape(1, 1);
+        if (i == 0)
+            _samples.create(n, (int)features.total(), CV_32FC1);
+        Mat sample = _samples.row(i);
+        features.convertTo(sample, CV_32F, _window[i]);
+    }
+    //one dft along the scales for every feature
+    transpose(_samples, _columns);
+    dft(_columns, _xsf, DFT_ROWS | DFT_COMPLEX_OUTPUT);
+    if (_ysfRows.rows != _xsf.rows)
+        repeat(_ysf, _xsf.rows, 1, _ysfRows);
+}
+
+void KScale::processFrame(const Mat &frame,
+                          const Point2f &center,
+                          const Size2d &size)
+{
+    VIVA_TRACE_SCOPE("KScale::processFrame");
+    _scale = 1.;
+    if (!_initiated)
+        return;
+    
+    getSamples(frame, center, size);
+    //response = real(ifft(sum(num .* xsf) ./ (den + lambda)))
+    mulSpectrums(_xsf, _num, _response, DFT_ROWS, false);
+    reduce(_response, _sum, 0, CV_REDUCE_SUM);
+    float *data      = _sum.ptr<float>(0);
+    const float *den = _den.ptr<float>(0);
+    for (int i = 0; i < _params.scales; ++i)
+    {
+        float d = den[2 * i] + _params.lambda;
+        data[2 * i]     /= d;
+        data[2 * i + 1] /= d;
+    }
+    idft(_sum, _spatial, DFT_ROWS | DFT_SCALE | DFT_REAL_OUTPUT);
+    
+    double maxVal; Point maxLoc;
+    minMaxLoc(_spatial, 0, &maxVal, 0, &maxLoc);
+    
+    //accumulated scale relative to the initial target, kept within the limits
+    double current = sqrt((size.width * size.height) /
+                          (_initialSize.width * _initialSize.height));
+    double factor  = min(_maxFactor, max(_minFactor, current * _factors[maxLoc.x]));
+    _scale = factor / current;
+}
+
+void KScale::update(const Mat &frame,
+                    const Point2f &center,
+                    const Size2d &size)
+{
+    VIVA_TRACE_SCOPE("KScale::update");
+    if (!_initiated)
+        initialize(size);
+    
+    getSamples(frame, center, size);
+    float lr = _initiated ? _params.interp_factor : 1.0;
+    
+    //num = ysf .* conj(xsf)
+    mulSpectrums(_ysfRows, _xsf, _response, DFT_ROWS, true);
+    if (!_initiated)
+        _response.copyTo(_num);
+    else
+        addWeighted(_num, 1 - lr, _response, lr, 0, _num);
+    
+    //den = sum(xsf .* conj(xsf)) over the features
+    mulSpectrums(_xsf, _xsf, _response, DFT_ROWS, true);
+    reduce(_response, _sum, 0, CV_REDUCE_SUM);
+    if (!_initiated)
+        _sum.copyTo(_den);
+    else
+        addWeighted(_den, 1 - lr, _sum, lr, 0, _den);
+    
+    _initiated = true;
+}
+
+template<KType kernel, bool complex>
+KTrackers::ProcessFrame KTrackers::specialize(KFeat feature)
+{
+    switch (feature)
+    {
+        case KFeat::GRAY:
+            return &KTrackers::processFrame<kernel, KFeat::GRAY, complex>;
+        case KFeat::RGB:
+            return &KTrackers::processFrame<kernel, KFeat::RGB,  complex>;
+        case KFeat::HLS:
+            return &KTrackers::processFrame<kernel, KFeat::HLS,  complex>;
+        case KFeat::HSV:
+            return &KTrackers::processFrame<kernel, KFeat::HSV,  complex>;
+        case KFeat::FHOG:
+        default:
+            return &KTrackers::processFrame<kernel, KFeat::FHOG, complex>;
+    }
+}
+
+KTrackers::ProcessFrame KTrackers::specialize(const ConfigParams &params)
+{
+    bool complex = (params.flags & DFT_COMPLEX_OUTPUT) != 0;
+    switch (params.kernel_type)
+    {
+        case KType::LINEAR:
+            return complex ? specialize<KType::LINEAR, true>(params.kernel_feature) :
+                             specialize<KType::LINEAR, false>(params.kernel_feature);
+        case KType::POLYNOMIAL:
+            return complex ? specialize<KType::POLYNOMIAL, true>(params.kernel_feature) :
+                             specialize<KType::POLYNOMIAL, false>(params.kernel_feature);
+        case KType::GAUSSIAN:
+        default:
+            return complex ? specialize<KType::GAUSSIAN, true>(params.kernel_feature) :
+                             specialize<KType::GAUSSIAN, false>(params.kernel_feature);
+    }
+}
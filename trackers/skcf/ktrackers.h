@@ -20,6 +20,7 @@
 #include <opencv2/core/core.hpp>
 #include "opencv2/imgproc/imgproc.hpp"
 #include "gradient.h"
+#include "trace.h"
 
 using namespace cv;
 using namespace std;
@@ -30,6 +31,9 @@ using namespace std;
 // Linear = DCF
 enum class KType{GAUSSIAN, POLYNOMIAL, LINEAR};
 enum class KFeat{GRAY, RGB, FHOG, HLS, HSV};
+// Flow = sparse keypoints (KFlow)
+// DSST = scale space correlation filter (KScale)
+enum class KScaleType{FLOW, DSST};
 
 struct ConfigParams{
     float padding = 1.5;  //Extra area surrounding the target
@@ -46,17 +50,22 @@ struct ConfigParams{
     int   hog_orientations = 1;
     int   cell_size = 1;
     bool  scale     = false;     //Toggle for scale computation
+    KScaleType scale_type = KScaleType::FLOW; //Scale estimation used when scale is on
     
     // 0 value uses compact CCS packed format for the spectrum. DFT_COMPLEX_OUTPUT;
     //Look for OpenCV dft function flags parameter
     int flags   = 0;
     
+    //Split the channel loops over the thread budget. Turn off when every
+    //target already runs on its own thread (multi-target runs).
+    bool parallel = true;
+    
     
     ConfigParams(KType ktype, bool compScale):
     padding(1.5), lambda(1e-4), output_sigma_factor(0.1),
     kernel_feature(KFeat::GRAY), kernel_type(ktype), kernel_sigma(0.2),
     kernel_poly_a(1), kernel_poly_b(7), interp_factor(0.075), hog_orientations(1),
-    cell_size(1),scale(compScale), flags(0)
+    cell_size(1),scale(compScale), scale_type(KScaleType::FLOW), flags(0), parallel(true)
     {}
 };
 
@@ -125,6 +134,65 @@ struct FHOGConfigParams: public ConfigParams {
     }
 };
 
+/* Spectrum of a window, computed on first use after the window changes */
+struct TSpectrum{
+    Mat   spectrum;
+    bool  valid = false;
+};
+
+/* Windows and labels of the filter. They only depend on the window size and
+ * on the target size, so they are rebuilt only when one of these changes. */
+struct TCache{
+    Size2i          size;   // Window size in cells the entries were built for
+    int         cellSize = 0;
+    float          sigma = 0;   // Bandwidth of the labels
+    float         sigmaW = 0;   // Horizontal bandwidth of the gaussian window
+    float         sigmaH = 0;   // Vertical bandwidth of the gaussian window
+    Mat             hann;   // Cosine window used for detection
+    Mat         gaussian;   // Gaussian window used for training
+    TSpectrum      hannF;   // Fourier Domain: cosine window (mean removal)
+    TSpectrum  gaussianF;   // Fourier Domain: gaussian window (mean removal)
+    Mat               yf;   // Fourier Domain: gaussian shaped labels
+};
+
+/* Number of feature channels of each feature type. The color features have
+ * a constant count, FHOG depends on the parameters (orientations) and its
+ * count is 0; the zero channel of the descriptor is dropped. */
+template<KFeat feature> struct KFeatTraits{
+    static constexpr int count = 3; //a gray patch gives a single RGB channel
+    static int channels(const ConfigParams &params) { return count; }
+};
+template<> struct KFeatTraits<KFeat::GRAY>{
+    static constexpr int count = 1;
+    static int channels(const ConfigParams &params) { return count; }
+};
+template<> struct KFeatTraits<KFeat::FHOG>{
+    static constexpr int count = 0;
+    static int channels(const ConfigParams &params) { return params.hog_orientations * 3 + 4; }
+};
+
+/* Intermediate buffers of the filter. They keep their storage between
+ * frames, so a warm tracker reuses them instead of allocating. */
+struct TWorkspace{
+    Mat            patch;   // Window around the target
+    Mat            color;   // Color conversion of the patch
+    Mat         floatImg;   // Gray patch in floating point (FHOG)
+    vector<Mat>      hog;   // FHOG channels, the last one is only zeros
+    FHogBuffer hogBuffer;   // Scratch memory of fhog
+    vector<Mat> features;   // Windowed features of the patch
+    vector<float>  means;   // Means of the color channels, removed from the spectrums
+    vector<Mat>       xf;   // Fourier Domain: features of the training step
+    vector<Mat>       zf;   // Fourier Domain: features of the detection step
+    Mat               kf;   // Fourier Domain: kernel autocorrelation
+    Mat              kzf;   // Fourier Domain: kernel cross-correlation
+    Mat           alphaf;   // Fourier Domain: regression of the current frame
+    Mat             sumF;   // Fourier Domain: channel sum of a correlation
+    Mat         response;   // Fourier Domain: product of two spectrums
+    Mat          spatial;   // Spatial domain: kernel or detection response
+    vector<Mat>   blockF;   // Fourier Domain: channel sums of the blocks after the first one
+    vector<Mat> blockResponse; // Fourier Domain: products of the blocks after the first one
+};
+
 /* Internal representation of the object by size and location */
 struct TObj{
     bool       initiated = false;
@@ -133,6 +201,8 @@ struct TObj{
     Point2f       center;   // Center location of the object
     vector<Mat> model_xf;   // Fourier Domain: model of the tracking obj.
     Mat     model_alphaf;   // Fourier Domain: Kernel Ridge Regression.
+    TCache         cache;   // Windows and labels of the current window size
+    TWorkspace      work;   // Buffers reused between frames
 };
 
 struct KFlowConfigParams
@@ -146,6 +216,7 @@ struct KFlowConfigParams
     int method = CV_TM_CCORR_NORMED;
     int transMode = 1;     //O : Median.  1: Centroid
     int ptsThreshold = 5;
+    int maxScalePairs = 1024; //MAXIMUM NUMBER OF POINT PAIRS FOR THE SCALE
     
     //Shi-Tomasi features  / Harris Corner Detector
     double     qualityLevel = 0.01;
@@ -155,6 +226,13 @@ struct KFlowConfigParams
     double                k = 0.04;
     int maxCorners          = 100;
     
+    //Maintenance of the tracked points
+    int    randomPoints   = 100;  //RANDOM POINTS OF A FULL EXTRACTION
+    double minWeight      = 0.85; //MINIMUM HANN WEIGHT OF A POINT
+    int    gridCells      = 4;    //CELLS PER SIDE OF THE COVERAGE GRID
+    int    redetectFrames = 10;   //FRAMES BETWEEN CORNER DETECTIONS
+    double minSurvival    = 0.1;  //FRACTION OF POINTS KEPT BY THE FB CHECK UNDER WHICH CORNERS ARE DETECTED AGAIN
+    
 };
 
 class KFlow
@@ -166,8 +244,21 @@ public:
     Mat _curr;
     double _scale;
     
+    Mat         _next;      // Gray patch of the incoming frame, storage reused
+    vector<Mat> _currPyr;   // LK pyramid of _curr, built by setReference
+    vector<Mat> _nextPyr;   // LK pyramid of _next, storage reused
+    
+    vector<Point2f> _tracked;  // Survivors of the last frame, next reference coordinates
+    size_t          _checked;  // Points that entered the forward-backward check of the last frame
+    int             _frames;   // Updates since the last corner detection
+    size_t          _detected; // Points of the last full extraction
+    Size            _hannSize; // Size of the cached Hann tables
+    vector<float>   _hannW, _hannH;
+    RNG             _rng;
+    
     
-    KFlow():_params(), _pts(), _curr(), _scale(1.)
+    KFlow():_params(), _pts(), _curr(), _scale(1.),
+    _checked(0), _frames(0), _detected(0), _rng(0xFFFFFFFF)
     {}
     
     static void toGray(const Mat &input, Mat &output)
@@ -191,25 +282,54 @@ public:
     }
     
     
+    /**
+     * Extracts a new set of points on the target: corners and random samples
+     */
     void extractPoints(const Mat &frame,
-                       const Size2d size)
+                       const Size2d size);
+    /**
+     * Keeps the points that survived the last frame and only tops up the
+     * cells of the target they no longer cover. Corners are detected again
+     * every redetectFrames updates or when the forward-backward check kept
+     * less than minSurvival of the points. The check keeps the points under
+     * the median FB error and over the median NCC, at most half of them on
+     * a good frame, so the threshold is well under 50%.
+     */
+    void updatePoints(const Mat &frame,
+                      const Size2d size);
+    /**
+     * Forgets the tracked points
+     */
+    void reset()
     {
-        toGray(frame, _curr);
-        extractPoints(_curr, _params, size, _pts, _weights);
+        _pts.clear();
+        _weights.clear();
+        _tracked.clear();
+        _checked  = 0;
+        _frames   = 0;
+        _detected = 0;
     }
     void processFrame(const Mat &frame,
                       const Mat &weights,
                       const Size2d &size,
                       const Point2f &shift)
     {
-        Mat tmp;
-        toGray(frame, tmp);
+        VIVA_TRACE_SCOPE("KFlow::processFrame");
+        toGray(frame, _next);
+        buildOpticalFlowPyramid(_next, _nextPyr, _params.winLK, _params.level);
         
         _scale = 1.0;
         if (_pts.size() > 0)
         {
+            if (_currPyr.empty())
+                buildOpticalFlowPyramid(_curr, _currPyr, _params.winLK, _params.level);
             vector<Point2f> to;
-            flowForwardBackward(_curr, tmp, _pts, to, _params);
+            _checked = _pts.size();
+            flowForwardBackward(_currPyr, _nextPyr, _curr, _next, _pts, to, _params);
+            //weights of the points kept by the forward-backward check
+            _weights.resize(_pts.size());
+            for (size_t i = 0; i < _pts.size(); ++i)
+                _weights[i] = weight(_pts[i]);
             _scale = transform(_pts, to, _weights, _params);
             
             int inliers = 0, outliers = 0;
@@ -226,88 +346,38 @@ public:
             
             if (outliers > inliers)
                 _scale = 1.0;
-                
-        }
-        
-        tmp.copyTo(_curr);
-    }
-    
-public:
-    static void extractPoints(const Mat& patch,
-                              const KFlowConfigParams &p,
-                              const Size2d  &size,
-                              vector<Point2f> &points,
-                              vector<float> &weights)
-    {
-        
-        assert(patch.type() == CV_8UC1);
-        
-        int width = patch.cols;
-        int height= patch.rows;
-        float *w = new float[width];
-        float *h = new float[height];
-        for (size_t i = 0; i < width; ++i )
-            w[i] = .5 * ( 1. - cos((2.* CV_PI* i)/(width - 1)));
-        for (size_t i = 0; i < height; ++i)
-            h[i] = .5 * ( 1. - cos((2.* CV_PI* i)/(height- 1)));
-        
-        int POINTS = 100;
-        double wTHRESHOLD = 0.85;
-        
-        RNG rng(0xFFFFFFFF);
-        Point tl(max(0.0,patch.cols/2.0 - floor(size.width/2.0)),
-                 max(0.0,patch.rows/2.0 - floor(size.height/2.0)));
-        
-        Point br(tl + Point(floor(size.width), floor(size.height)));
-        
-        Mat mask = Mat::zeros(patch.size(),CV_8UC1);
-        rectangle(mask, tl, br, Scalar(255), CV_FILLED);
-        vector<Point2f> _tmp;
-        goodFeaturesToTrack(patch,
-                            _tmp,
-                            p.maxCorners,
-                            p.qualityLevel,
-                            p.minDistance,
-                            mask,
-                            p.blockSize,
-                            p.useHarrisDetector,
-                            p.k);
-        weights.clear();
-        points.clear();
-        
-        for (int i = 0; i < _tmp.size(); i++)
-        {
-            int _x_ = floor(_tmp[i].x);
-            int _y_ = floor(_tmp[i].y);
-            double _weight =w[_x_] * h[_y_];
             
-            if (_weight < wTHRESHOLD) continue;
-            weights.push_back(_weight);
-            points.push_back(_tmp[i]);
-                
+            //the next reference is centered on the shifted target
+            _tracked.resize(to.size());
+            for (size_t i = 0; i < to.size(); ++i)
+                _tracked[i] = to[i] - shift;
         }
-
-        for (int i = 0; i < POINTS ; ++i)
+        else
         {
-            double nX = rng.uniform((double)tl.x,(double) (br.x));
-            double nY = rng.uniform((double)tl.y,(double) (br.y));
-            int _x_ = floor(nX);
-            int _y_ = floor(nY);
-            double _weight =w[_x_] * h[_y_];
-            if (_weight <  wTHRESHOLD) continue;
-        
-            weights.push_back(_weight);
-            points.push_back(Point2f(nX,nY));
-        
+            _tracked.clear();
+            _checked = 0;
         }
-        
-        delete[] w;
-        delete[] h;
-            
+        //the reference is not kept: updatePoints sets the patch centered
+        //on the shifted target as the next one
     }
     
+private:
+    //  Gray reference patch and its LK pyramid
+    void setReference(const Mat &frame);
+    //  Hann weights of the rows and columns of the patch, rebuilt on resize
+    void hannTables(const Size &size);
+    float weight(const Point2f &pt) const
+    {
+        int x = min(max(cvFloor(pt.x), 0), _hannSize.width  - 1);
+        int y = min(max(cvFloor(pt.y), 0), _hannSize.height - 1);
+        return _hannW[x] * _hannH[y];
+    }
+    //  Box of the target centered in the patch
+    Rect targetBox(const Size2d &size) const;
+    //  Adds random samples with enough weight inside the box
+    void samplePoints(const Rect &box, int count);
     
-    
+public:
     /*
      * tracks area B to BNew using two images frame I and J.
      */
@@ -322,6 +392,18 @@ public:
                                     vector<Point2f> &from,
                                     vector<Point2f> &to,
                                     const KFlowConfigParams &p);
+    /*
+     * Same as above with the LK pyramids of I and J already built
+     * (buildOpticalFlowPyramid with p.winLK and p.level). Both passes
+     * share them.
+     */
+    static void flowForwardBackward(const vector<Mat> &pyrI,
+                                    const vector<Mat> &pyrJ,
+                                    const Mat &I,
+                                    const Mat &J,
+                                    vector<Point2f> &from,
+                                    vector<Point2f> &to,
+                                    const KFlowConfigParams &p);
     
     
     /*
@@ -394,15 +476,110 @@ private:
 };
 
 
-class KTrackers
+struct KScaleConfigParams
+{
+    int   scales        = 33;    //NUMBER OF SCALES OF THE PYRAMID
+    float step          = 1.02;  //SCALE RATIO BETWEEN CONSECUTIVE SAMPLES
+    float sigma_factor  = 0.25;  //BANDWIDTH OF THE LABELS (PROPORTIONAL TO SCALES)
+    float lambda        = 1e-2;  //REGULARIZATION
+    float interp_factor = 0.025; //LINEAR INTERPOLATION FACTOR FOR ADAPTATION
+    int   max_area      = 512;   //MAXIMUM AREA OF THE RESAMPLED TARGET
+    int   cell_size     = 4;     //CELL SIZE OF THE FHOG DESCRIPTOR
+    int   orientations  = 9;     //ORIENTATIONS OF THE FHOG DESCRIPTOR
+    float min_factor    = 0.2;   //MINIMUM SCALE RELATIVE TO THE INITIAL TARGET
+    float max_factor    = 5.0;   //MAXIMUM SCALE RELATIVE TO THE INITIAL TARGET
+    float min_side      = 5;     //MINIMUM SIDE OF THE TARGET IN PIXELS
+};
+
+/*
+ * One dimensional correlation filter over a pyramid of resampled target
+ * patches (Danelljan et al. Accurate Scale Estimation for Robust Visual
+ * Tracking, BMVC 2014). Every scale sample is a column of FHOG features,
+ * the filter runs one batch of row DFTs along the scales per frame, so
+ * its cost does not depend on the texture of the target.
+ */
+class KScale
 {
+    KScaleConfigParams _params;
+public:
+    KScale():_params(), _initiated(false), _scale(1.)
+    {}
+    
+    /**
+     * Forgets the model, the next update starts a new one
+     */
+    void reset()
+    {
+        _initiated = false;
+        _scale     = 1.;
+    }
+    /**
+     * Estimates the scale change of the target of the given size at center.
+     * The accumulated scale stays within the limits of the parameters,
+     * relative to the size of the target when the model was started.
+     */
+    void processFrame(const Mat &frame,
+                      const Point2f &center,
+                      const Size2d &size);
+    /**
+     * Trains (first call) or adapts the filter with the target at center
+     */
+    void update(const Mat &frame,
+                const Point2f &center,
+                const Size2d &size);
     
+    double getScale()
+    {
+        return _scale;
+    }
+    KScaleConfigParams &getParams()
+    {
+        return _params;
+    }
+    
+private:
+    bool          _initiated;
+    double        _scale;
+    Size2d        _initialSize; // Target size when the model was started
+    double        _minFactor;   // Scale limits relative to _initialSize
+    double        _maxFactor;
+    Size          _modelSize;   // Size of the resampled target
+    vector<float> _factors;     // Scale of each sample
+    vector<float> _window;      // Cosine window along the scales
+    Mat           _ysf;         // Fourier Domain: gaussian shaped labels
+    Mat           _ysfRows;     // Fourier Domain: labels, one row per feature
+    Mat           _num;         // Fourier Domain: numerator of the filter
+    Mat           _den;         // Fourier Domain: denominator of the filter
+    
+    Mat           _patch, _resized, _gray, _floatImg, _hog;
+    FHogBuffer    _hogBuffer;   // Scratch memory of fhog, shared by the samples
+    Mat           _samples;     // One row per scale
+    Mat           _columns;     // One column per scale
+    Mat           _xsf, _response, _sum, _spatial;
+    
+    void initialize(const Size2d &size);
+    void getSamples(const Mat &frame,
+                    const Point2f &center,
+                    const Size2d &size);
+};
+
+class KTrackers
+{
+    //microbenchmarks of the static kernels (micro folder)
+    friend class KernelBenchmark;
 public:
     KTrackers(KType type, KFeat feat, bool scale);
     
+    /**
+     * Sets the target and selects the specialization of the filter for the
+     * kernel, feature and spectrum layout of the current parameters.
+     */
     void setArea(const RotatedRect &rect);
     void getTrackedArea(vector<Point2f> &pts);
-    void processFrame(const cv::Mat &frame);
+    void processFrame(const cv::Mat &frame)
+    {
+        (this->*_process)(frame);
+    }
     
     void getTrackedPoints(vector<Point2f> &pts)
     {
@@ -429,14 +606,35 @@ public:
     {
         return _params.scale;
     }
+    /**
+     * Parameters of the filter. They can be modified before the target area is set.
+     */
+    ConfigParams &getParams()
+    {
+        return _params;
+    }
     
 protected:
+    typedef void (KTrackers::*ProcessFrame)(const cv::Mat &frame);
+    
     TObj         _target;
     ConfigParams _params;
     KFlow        _flow;
+    KScale       _scaleFilter;
+    ProcessFrame _process;
     
     Point2f      _ptl;
     
+    //  One frame of the filter, specialized for the kernel, the features and
+    //  the spectrum layout (complex == DFT_COMPLEX_OUTPUT, CCS otherwise).
+    template<KType kernel, KFeat feature, bool complex>
+    void processFrame(const cv::Mat &frame);
+    
+    //  Specialization of processFrame for the given parameters
+    static ProcessFrame specialize(const ConfigParams &params);
+    template<KType kernel, bool complex>
+    static ProcessFrame specialize(KFeat feature);
+    
     
 private:
     template<typename T>
@@ -465,7 +663,23 @@ private:
     static void getFeatures(const Mat& patch,
                             const ConfigParams &params,
                             const Mat& windowFunction,
-                            vector<Mat> &features);
+                            vector<Mat> &features,
+                            TWorkspace &ws);
+    template<KFeat feature>
+    static void getFeatures(const Mat& patch,
+                            const ConfigParams &params,
+                            const Mat& windowFunction,
+                            vector<Mat> &features,
+                            TWorkspace &ws);
+    //  Windowed feature channels of the patch. Color features are converted,
+    //  scaled and windowed by one fused kernel; their means are left in
+    //  ws.means and removed from the spectrums by removeMeans.
+    template<KFeat feature>
+    static void extractFeatures(const Mat& patch,
+                                const ConfigParams &params,
+                                const Mat& windowFunction,
+                                vector<Mat> &features,
+                                TWorkspace &ws);
     
     static void getPoints(const Mat& image,
                           const Mat& patch,
@@ -481,6 +695,9 @@ private:
     static void fft2(const vector<Mat> &features,vector<Mat> &fft2, const ConfigParams &params);
     static void fft2(Mat &fft2, const ConfigParams &params); //inplace
     static void fft2(const Mat &features, Mat &fft2, const ConfigParams &params);
+    //  Same with the layout as a constant, complex == DFT_COMPLEX_OUTPUT.
+    template<bool complex>
+    static void fft2(const vector<Mat> &features,vector<Mat> &fft2, const ConfigParams &params);
     
     //   GAUSSIAN_CORRELATION Gaussian Kernel at all shifts, i.e. kernel correlation.
     //   Evaluates a Gaussian kernel with bandwidth SIGMA for all relative
@@ -493,13 +710,32 @@ private:
     //   INPUTS:
     //        XF  vector of channels in frequency domain.
     //        YF  vector of channels in frequency domain.
+    //        WS  buffers reused between calls.
     //   OUTPUT:
     //        kf  in frequency domain
     static void gaussian_correlation(const vector<Mat> &xf,
                                      const vector<Mat> &yf,
                                      const ConfigParams &params,
                                      Mat &kf,
+                                     TWorkspace &ws,
                                      bool autocorrelation = false);
+    template<bool complex>
+    static void gaussian_correlation(const vector<Mat> &xf,
+                                     const vector<Mat> &yf,
+                                     const ConfigParams &params,
+                                     Mat &kf,
+                                     TWorkspace &ws,
+                                     bool autocorrelation);
+    
+    //   Kernel correlation selected at compile time. The autocorrelation
+    //   flag only speeds up the gaussian kernel.
+    template<KType kernel, bool complex>
+    static void correlation(const vector<Mat> &xf,
+                            const vector<Mat> &yf,
+                            const ConfigParams &params,
+                            Mat &kf,
+                            TWorkspace &ws,
+                            bool autocorrelation);
 
    
     
@@ -515,11 +751,15 @@ private:
     //   INPUTS:
     //        XF  vector of channels in frequency domain.
     //        YF  vector of channels in frequency domain.
+    //        PARAMS configuration parameters.
+    //        WS  buffers reused between calls.
     //   OUTPUT:
     //        kf  in frequency domain
     static void linear_correlation(const vector<Mat> &xf,
                                    const vector<Mat> &yf,
-                                   Mat &kf);
+                                   const ConfigParams &params,
+                                   Mat &kf,
+                                   TWorkspace &ws);
 
     
     //   POLYNOMIAL_CORRELATION Polynomial Kernel at all shifts, i.e. kernel correlation.
@@ -533,12 +773,20 @@ private:
     //   INPUTS:
     //        XF  vector of channels in frequency domain.
     //        YF  vector of channels in frequency domain.
+    //        WS  buffers reused between calls.
     //   OUTPUT:
     //        kf  in frequency domain
     static void polynomial_correlation(const vector<Mat> &xf,
                                        const vector<Mat> &yf,
                                        const ConfigParams &params,
-                                       Mat &kf);
+                                       Mat &kf,
+                                       TWorkspace &ws);
+    template<bool complex>
+    static void polynomial_correlation(const vector<Mat> &xf,
+                                       const vector<Mat> &yf,
+                                       const ConfigParams &params,
+                                       Mat &kf,
+                                       TWorkspace &ws);
 
     // Equation for fast detection
     // location is at the maximum response. we must take into
@@ -547,7 +795,8 @@ private:
     // the responses wrap around cyclically.
     static double fastDetection(const Mat &modelAlphaF,
                                 const Mat &kzf,
-                                Point &location);
+                                Point &location,
+                                TWorkspace &ws);
     
     
     static void  getPatch(const Mat& image,
@@ -577,12 +826,29 @@ private:
     //  Filtering window
     static void  hannWindow(const Size &sz, Mat &filter);
     
+    //  Cosine window of size sz, rebuilt only when the window size changes
+    static const Mat& cachedHann(const Size &sz,
+                                 const ConfigParams &params,
+                                 TCache &cache);
+    //  Gaussian window and label spectrum, rebuilt only when their bandwidths change
+    static void  cachedLabels(const Size &sz,
+                              float sigma,
+                              float sigmaW,
+                              float sigmaH,
+                              const ConfigParams &params,
+                              TCache &cache);
+    
     //  Equation for fast trainning
     static void fastTraining(const Mat &yf,
                              const Mat &kf,
                              const ConfigParams& params,
                              Mat &alphaf);
-    //  Learning the modle
+    template<bool complex>
+    static void fastTraining(const Mat &yf,
+                             const Mat &kf,
+                             const ConfigParams& params,
+                             Mat &alphaf);
+    //  Learning the modle. The models are interpolated in place.
     static void learn(vector<Mat> &modelXf, const vector<Mat> &xf,
                       Mat         &modelAlphaF, const Mat &alphaf,
                       const ConfigParams& params);
@@ -590,8 +856,40 @@ private:
     //  The parameters lambda is just a regularization term to avoid division by zero.
     static void divSpectrums( InputArray _srcA, InputArray _srcB,
                              OutputArray _dst, int flags, bool conjB = false ,double lambda = 1e-4);
+    //  Same with the layout as a constant, for single precision spectrums.
+    template<bool complex>
+    static void divSpectrums(const Mat &srcA, const Mat &srcB, Mat &dst, double lambda);
     //  Sum all the real values of the spectrum. 
     static double sumSpectrum(const Mat &mat, const ConfigParams &params);
+    template<bool complex>
+    static double sumSpectrum(const Mat &mat);
+    //  Removes the means of the feature channels from their spectrums using
+    //  the spectrum of the window, built on first use. No-op without means.
+    template<bool complex>
+    static void removeMeans(vector<Mat> &xf,
+                            const vector<float> &means,
+                            const Mat &window,
+                            TSpectrum &windowF);
+    //  Number of blocks of a channel loop: one for every 64K elements of work,
+    //  a single one below 128K elements or when params.parallel is off. It only
+    //  depends on the work, never on the threads granted by the budget.
+    static size_t channelBlocks(size_t channels, const ConfigParams &params, size_t work);
+    //  Runs body over the channel range, split in channelBlocks blocks run
+    //  on the thread budget. For loops whose channels are independent.
+    static void parallelChannels(const Range &channels,
+                                 const std::function<void(const Range&)> &body,
+                                 const ConfigParams &params,
+                                 size_t work);
+    //  Runs body(block, channels of the block) for every block of the channel
+    //  range on the thread budget. Reductions keep one partial per block and
+    //  merge them in block order afterwards, so the result is deterministic.
+    static void parallelBlocks(const Range &channels,
+                               size_t blocks,
+                               const std::function<void(size_t, const Range&)> &body);
+    //  Energy of a spectrum, sum of its squared magnitudes (Parseval).
+    static double energySpectrum(const Mat &xf, const ConfigParams &params);
+    template<bool complex>
+    static double energySpectrum(const Mat &xf);
 };
 
 
@@ -42,6 +42,11 @@ public:
         kcf.setArea(rect);
     }
     
+    ConfigParams &getParams()
+    {
+        return kcf.getParams();
+    }
+    
     //@Override
     void initialize(const cv::Mat &image,
                     const cv::Rect &rect)
@@ -32,6 +32,7 @@
 #include "Kernels.h"
 #include "Sample.h"
 #include "Rect.h"
+#include "trace.h"
 //#include "GraphUtils/GraphUtils.h"
 
 //#include <Eigen/Array>
@@ -86,6 +87,7 @@ void LaRank::Eval(const MultiSample& sample, std::vector<double>& results)
 
 void LaRank::Update(const MultiSample& sample, int y)
 {
+	VIVA_TRACE_SCOPE("LaRank::Update");
 	// add new support pattern
 	SupportPattern* sp = new SupportPattern;
 	const vector<FloatRect>& rects = sample.GetRects();
@@ -39,6 +39,7 @@
 #include "Kernels.h"
 
 #include "LaRank.h"
+#include "trace.h"
 
 #include <opencv/cv.h>
 #include <opencv/highgui.h>
@@ -139,6 +140,7 @@ void STRUCKtracker::Reset()
 
 void STRUCKtracker::Init(const cv::Mat& frame, FloatRect bb)
 {
+	VIVA_TRACE_SCOPE("STRUCK::Init");
 	m_bb = IntRect(bb);
 	ImageRep image(frame, m_needsIntegralImage, m_needsIntegralHist);
 	for (int i = 0; i < 1; ++i)
@@ -150,6 +152,7 @@ void STRUCKtracker::Init(const cv::Mat& frame, FloatRect bb)
 
 void STRUCKtracker::Track(const cv::Mat& frame)
 {
+	VIVA_TRACE_SCOPE("STRUCK::Track");
 	assert(m_initialised);
 	
 	ImageRep image(frame, m_needsIntegralImage, m_needsIntegralHist);
@@ -192,6 +195,7 @@ void STRUCKtracker::Track(const cv::Mat& frame)
 
 void STRUCKtracker::UpdateLearner(const ImageRep& image)
 {
+	VIVA_TRACE_SCOPE("STRUCK::UpdateLearner");
 	// note these return the centre sample at index 0
 	vector<FloatRect> rects = Sampler::RadialSamples(m_bb, 2*m_config.searchRadius, 5, 16);
 	//vector<FloatRect> rects = Sampler::PixelSamples(m_bb, 2*m_config.searchRadius, true);
@@ -68,6 +68,16 @@ public:
 
 		Reset();
 	}
+
+	// sets the search and learner parameters keeping the configured features
+	void configure(int searchRadius, double svmC, int svmBudgetSize)
+	{
+		m_config.searchRadius  = searchRadius;
+		m_config.svmC          = svmC;
+		m_config.svmBudgetSize = svmBudgetSize;
+
+		Reset();
+	}
 	
     //@Override
     void initialize(const cv::Mat &im_gray, const cv::Rect &rect)
@@ -171,3 +171,35 @@ bool ImageListInput::getFrame(Mat &frame)
     return false;
 }
 
+bool VideoInput::seek(size_t frameN)
+{
+    //cameras and streams do not report a position
+    if (!_opened || !_CameraInput.set(CV_CAP_PROP_POS_FRAMES, (double)frameN))
+        return false;
+    return (size_t)_CameraInput.get(CV_CAP_PROP_POS_FRAMES) == frameN;
+}
+
+bool ImageListInput::seek(size_t frameN)
+{
+    if (!_opened || frameN > _filenames.size())
+        return false;
+    _it = _filenames.begin() + frameN;
+    return true;
+}
+
+bool MemoryInput::seek(size_t frameN)
+{
+    if (frameN > _frames.size())
+        return false;
+    _frameN = frameN;
+    return true;
+}
+
+bool MemoryInput::getFrame(Mat &frame)
+{
+    if (_frameN >= _frames.size())
+        return false;
+    frame = _frames[_frameN++];
+    _orgSize = _size = frame.size();
+    return true;
+}
@@ -79,6 +79,13 @@ namespace viva
          */
         virtual bool  getFrame(Mat &image) = 0;
 
+        /**
+         *  Moves the input to a frame number, the next call to getFrame returns it.
+         *  @return bool: false if the input can not seek. Frames have to be read
+         *                and discarded to reach frameN.
+         */
+        virtual bool  seek(size_t frameN) { return false; }
+
         /**
          *  Virtual desctructor
          */
@@ -167,6 +174,12 @@ namespace viva
          * @param frame: output image frame from the sequence
          */
         bool getFrame(Mat &frame);
+
+        /**
+         * Overrided from Input Base Class. Sets the position of video files, cameras
+         * and streams can not seek.
+         */
+        bool seek(size_t frameN);
     };
     
     /**
@@ -221,8 +234,38 @@ namespace viva
          * @param frame: output image frame from the sequence
          */
         bool getFrame(Mat &frame);
+
+        /**
+         * Overrided from Input Base Class. Moves to the frameN-th image of the list.
+         */
+        bool seek(size_t frameN);
+    };
     
+    /**
+     * MemoryInput replays frames already decoded in memory.
+     * The frames are shared, not copied, so several inputs can replay
+     * the same decoded sequence concurrently.
+     */
+    class MemoryInput: public Input
+    {
+    private:
+        vector<Mat> _frames;
+        size_t _frameN;
+        
+    public:
+        MemoryInput(const vector<Mat> &frames):
+            Input(), _frames(frames), _frameN(0)
+        {}
+        
+        /**
+         * Overrided from Input Base Class. Returns the next frame of the list.
+         */
+        bool getFrame(Mat &frame);
 
+        /**
+         * Overrided from Input Base Class. Moves to the frameN-th frame of the list.
+         */
+        bool seek(size_t frameN);
     };
 }
 
@@ -0,0 +1,257 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "packed.h"
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+using namespace viva;
+
+const uint32_t PackedCodec::RAW     = 0;
+const uint32_t PackedCodec::ENCODED = 1;
+const uint32_t PackedCodec::PNG     = 2;
+
+static const char     PACKED_MAGIC[4] = {'V', 'P', 'K', '1'};
+static const uint32_t PACKED_VERSION  = 1;
+
+PackedWriter::PackedWriter(const string &filename, uint32_t codec):
+_file(filename.c_str(), std::ios::binary), _index(), _groundTruth(), _metadata(), _codec(codec), _closed(false)
+{
+    std::memset(&_header, 0, sizeof(_header));
+    std::memcpy(_header.magic, PACKED_MAGIC, sizeof(PACKED_MAGIC));
+    _header.version = PACKED_VERSION;
+    _file.write((const char *)&_header, sizeof(_header));
+}
+
+PackedWriter::~PackedWriter()
+{
+    close();
+}
+
+bool PackedWriter::writeChunk(const char *data, size_t size, uint32_t codec)
+{
+    PackedChunk chunk;
+    chunk.offset = (uint64_t)_file.tellp();
+    chunk.size   = (uint32_t)size;
+    chunk.codec  = codec;
+    _file.write(data, size);
+    _index.push_back(chunk);
+    return _file.good();
+}
+
+bool PackedWriter::write(const Mat &frame)
+{
+    if (_closed || frame.empty())
+        return false;
+    if (_index.empty())
+    {
+        _header.width  = frame.cols;
+        _header.height = frame.rows;
+        _header.type   = frame.type();
+    }
+    //the header describes every frame of the sequence
+    else if (frame.cols != _header.width || frame.rows != _header.height ||
+             frame.type() != _header.type)
+        return false;
+    
+    if (_codec == PackedCodec::RAW)
+    {
+        Mat continuous = frame.isContinuous() ? frame : frame.clone();
+        return writeChunk((const char *)continuous.data, continuous.total() * continuous.elemSize(), PackedCodec::RAW);
+    }
+    
+    vector<uchar> buffer;
+    vector<int> params;
+    params.push_back(IMWRITE_PNG_COMPRESSION);
+    params.push_back(1);
+    imencode(".png", frame, buffer, params);
+    return writeChunk((const char *)buffer.data(), buffer.size(), PackedCodec::PNG);
+}
+
+bool PackedWriter::writeEncoded(const string &imageFile)
+{
+    if (_closed)
+        return false;
+    
+    MappedFile image(imageFile);
+    if (!image.isOpen() || image.size() == 0)
+        return false;
+    if (_index.empty())
+    {
+        Mat frame = imread(imageFile);
+        _header.width  = frame.cols;
+        _header.height = frame.rows;
+        _header.type   = frame.type();
+    }
+    return writeChunk(image.data(), image.size(), PackedCodec::ENCODED);
+}
+
+void PackedWriter::setGroundTruth(const vector<vector<Point2f> > &gt)
+{
+    const float NaN = std::numeric_limits<float>::quiet_NaN();
+    _groundTruth.assign(gt.size() * 4, Point2f(NaN, NaN));
+    for (size_t i = 0; i < gt.size(); ++i)
+        for (size_t k = 0; k < gt[i].size() && k < 4; ++k)
+            _groundTruth[i * 4 + k] = gt[i][k];
+}
+
+bool PackedWriter::close()
+{
+    if (_closed || !_file.is_open())
+        return false;
+    _closed = true;
+    
+    _header.frames      = (uint32_t)_index.size();
+    _header.indexOffset = (uint64_t)_file.tellp();
+    _file.write((const char *)_index.data(), _index.size() * sizeof(PackedChunk));
+    
+    _header.groundTruthFrames = (uint32_t)(_groundTruth.size() / 4);
+    _header.groundTruthOffset = (uint64_t)_file.tellp();
+    _file.write((const char *)_groundTruth.data(), _groundTruth.size() * sizeof(Point2f));
+    
+    _header.metadataSize   = (uint32_t)_metadata.size();
+    _header.metadataOffset = (uint64_t)_file.tellp();
+    _file.write(_metadata.data(), _metadata.size());
+    
+    _file.seekp(0);
+    _file.write((const char *)&_header, sizeof(_header));
+    _file.close();
+    return !_file.fail();
+}
+
+PackedInput::PackedInput(const string &filename, const Size &size, int colorFlag, size_t readAhead):
+Input(size, colorFlag), _file(filename), _index(), _frameN(0), _readAhead(readAhead), _opened(false)
+{
+    std::memset(&_header, 0, sizeof(_header));
+    if (!_file.isOpen() || _file.size() < sizeof(_header))
+        return;
+    
+    std::memcpy(&_header, _file.data(), sizeof(_header));
+    if (std::memcmp(_header.magic, PACKED_MAGIC, sizeof(PACKED_MAGIC)) != 0 ||
+        _header.version != PACKED_VERSION ||
+        _header.indexOffset + (uint64_t)_header.frames * sizeof(PackedChunk) > _file.size() ||
+        _header.groundTruthOffset + (uint64_t)_header.groundTruthFrames * 4 * sizeof(Point2f) > _file.size() ||
+        _header.metadataOffset + _header.metadataSize > _file.size())
+        return;
+    
+    _index.resize(_header.frames);
+    std::memcpy(_index.data(), _file.data() + _header.indexOffset, _index.size() * sizeof(PackedChunk));
+    //raw chunks are wrapped in place, they must hold exactly one frame of the header
+    uint64_t rawSize = 0;
+    if (_header.width > 0 && _header.height > 0 && CV_MAT_DEPTH(_header.type) <= CV_64F)
+        rawSize = (uint64_t)_header.width * _header.height * CV_ELEM_SIZE(_header.type);
+    for (size_t i = 0; i < _index.size(); ++i)
+    {
+        if (_index[i].offset + _index[i].size > _file.size())
+            return;
+        if (_index[i].codec == PackedCodec::RAW && (rawSize == 0 || _index[i].size != rawSize))
+            return;
+    }
+    
+    _opened = true;
+}
+
+bool PackedInput::getFrame(size_t frameN, Mat &frame)
+{
+    if (!_opened || frameN >= _index.size())
+        return false;
+    
+    const PackedChunk &chunk = _index[frameN];
+    uchar *data = (uchar *)(_file.data() + chunk.offset);
+    if (chunk.codec == PackedCodec::RAW)
+        Mat(_header.height, _header.width, _header.type, data).copyTo(frame);
+    else
+        frame = imdecode(Mat(1, (int)chunk.size, CV_8UC1, data),
+                         (chunk.codec == PackedCodec::PNG) ? IMREAD_UNCHANGED : IMREAD_COLOR);
+    if (frame.empty())
+        return false;
+    
+    _orgSize = frame.size();
+    if (_size.width < 0 && _size.height < 0)
+    {
+        
+    }
+    else if (_size.width < 0 && _size.height > 0)
+    {
+        resize(frame, frame, Size(_orgSize.width*_size.height / _orgSize.height, _size.height));
+    }
+    else if (_size.width > 0 && _size.height < 0)
+    {
+        resize(frame, frame, Size(_size.width, _orgSize.height * _size.width / _orgSize.width));
+    }
+    else if (_size.width != frame.cols && _size.height != frame.rows)
+    {
+        resize(frame, frame, _size);
+    }
+    if (_convert)
+        cvtColor(frame, frame, _conversionFlag);
+    return true;
+}
+
+bool PackedInput::getFrame(Mat &frame)
+{
+    if (_frameN >= _index.size())
+        return false;
+    
+    // request the chunks of the next frames while the current one is decoded
+    size_t last = std::min(_index.size(), _frameN + 1 + _readAhead) - 1;
+    if (last > _frameN && (_frameN % std::max((size_t)1, _readAhead / 2)) == 0)
+    {
+        size_t begin = (size_t)_index[_frameN + 1].offset;
+        _file.willNeed(begin, (size_t)(_index[last].offset + _index[last].size) - begin);
+    }
+    return getFrame(_frameN++, frame);
+}
+
+void PackedInput::getGroundTruth(vector<vector<Point2f> > &gt) const
+{
+    gt.clear();
+    if (!_opened)
+        return;
+    
+    vector<Point2f> corners(_header.groundTruthFrames * 4);
+    std::memcpy(corners.data(), _file.data() + _header.groundTruthOffset, corners.size() * sizeof(Point2f));
+    gt.resize(_header.groundTruthFrames);
+    for (size_t i = 0; i < gt.size(); ++i)
+        if (!std::isnan(corners[i * 4].x))
+            gt[i].assign(corners.begin() + i * 4, corners.begin() + i * 4 + 4);
+}
+
+string PackedInput::getMetadata() const
+{
+    if (!_opened)
+        return "";
+    return string(_file.data() + _header.metadataOffset, _header.metadataSize);
+}
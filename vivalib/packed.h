@@ -0,0 +1,193 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __viva__packed__
+#define __viva__packed__
+
+#include "input.h"
+#include <fstream>
+#include <cstdint>
+
+using namespace cv;
+using namespace std;
+
+namespace viva
+{
+    /**
+     * Storage of the frame chunks inside a packed sequence
+     */
+    struct PackedCodec
+    {
+        const static uint32_t RAW;      /**< uncompressed pixels*/
+        const static uint32_t ENCODED;  /**< original image file bytes (e.g., the JPEG files of a dataset)*/
+        const static uint32_t PNG;      /**< lossless PNG with the fastest compression level*/
+    };
+    
+    /**
+     * Fixed size header at the beginning of a packed sequence file.
+     * The file layout is: header, frame chunks, index table (one PackedChunk per frame),
+     * ground-truth (4 corners per frame, NaN if not annotated) and metadata text.
+     */
+    struct PackedHeader
+    {
+        char     magic[4];
+        uint32_t version;
+        uint32_t frames;
+        int32_t  width;
+        int32_t  height;
+        int32_t  type;
+        uint64_t indexOffset;
+        uint64_t groundTruthOffset;
+        uint32_t groundTruthFrames;
+        uint32_t metadataSize;
+        uint64_t metadataOffset;
+    };
+    
+    /**
+     * Entry of the index table of a packed sequence
+     */
+    struct PackedChunk
+    {
+        uint64_t offset;
+        uint32_t size;
+        uint32_t codec;
+    };
+    
+    /**
+     * Writes a whole sequence (frames, ground-truth and metadata) into a single container file.
+     */
+    class PackedWriter
+    {
+    private:
+        std::ofstream _file;
+        PackedHeader _header;
+        vector<PackedChunk> _index;
+        vector<Point2f> _groundTruth;
+        string _metadata;
+        uint32_t _codec;
+        bool _closed;
+        
+        bool writeChunk(const char *data, size_t size, uint32_t codec);
+        
+    public:
+        /**
+         * @param filename: container file to create
+         * @param codec: storage of the frames added with write(Mat), PackedCodec::RAW or PackedCodec::PNG
+         */
+        PackedWriter(const string &filename, uint32_t codec = PackedCodec::PNG);
+        ~PackedWriter();
+        
+        bool isOpen() const { return _file.is_open(); }
+        /**
+         * Appends a decoded frame. Returns false if its size or type differs
+         * from the first frame of the sequence.
+         */
+        bool write(const Mat &frame);
+        /**
+         * Appends an image file as it is, without decoding and re-encoding it
+         */
+        bool writeEncoded(const string &imageFile);
+        /**
+         * Sets the ground-truth of the sequence, one list of corners per frame
+         */
+        void setGroundTruth(const vector<vector<Point2f> > &gt);
+        /**
+         * Sets a free text description stored with the sequence
+         */
+        void setMetadata(const string &metadata) { _metadata = metadata; }
+        /**
+         * Writes the index table, ground-truth and metadata. Called by the destructor if needed.
+         */
+        bool close();
+    };
+    
+    /**
+     * PackedInput reads a sequence stored with PackedWriter.
+     * The container is memory mapped: frames are read sequentially with a read-ahead
+     * window or randomly by frame number, touching a single file per sequence.
+     */
+    class PackedInput: public Input
+    {
+    private:
+        MappedFile _file;
+        PackedHeader _header;
+        vector<PackedChunk> _index;
+        size_t _frameN;
+        size_t _readAhead;
+        bool _opened;
+        
+    public:
+        /**
+         * @param filename: container file
+         * @param readAhead: number of frames requested in advance to the system while reading sequentially
+         */
+        PackedInput(const string &filename,
+                    const Size &size = Size(-1,-1),
+                    int colorFlag = -1,
+                    size_t readAhead = 8);
+        
+        bool isOpened() const { return _opened; }
+        /**
+         * Overrided from Input Base Class. Returns the next frame of the sequence.
+         */
+        bool getFrame(Mat &frame);
+        /**
+         * Random access to a frame. It does not change the sequential position.
+         */
+        bool getFrame(size_t frameN, Mat &frame);
+        /**
+         * Overrided from Input Base Class. Moves the sequential position to a frame number
+         */
+        bool seek(size_t frameN)
+        {
+            if (!_opened || frameN > _index.size())
+                return false;
+            _frameN = frameN;
+            return true;
+        }
+        
+        size_t getNumberOfFrames() const { return _index.size(); }
+        /**
+         * Returns the ground-truth stored with the sequence, one list of corners per frame.
+         * Frames without annotation have an empty list.
+         */
+        void getGroundTruth(vector<vector<Point2f> > &gt) const;
+        /**
+         * Returns the metadata text stored with the sequence
+         */
+        string getMetadata() const;
+    };
+}
+
+#endif /* defined(__viva__packed__) */
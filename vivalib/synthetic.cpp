@@ -0,0 +1,265 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "synthetic.h"
+#include <cstdio>
+#include <iomanip>
+
+using namespace viva;
+
+bool SyntheticConfig::parse(const string &description, SyntheticConfig &config)
+{
+    const string prefix = "synthetic";
+    if (description.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    string options = description.substr(prefix.size());
+    if (!options.empty() && options[0] != ':')
+        return false;
+    
+    config = SyntheticConfig();
+    istringstream ss(options.empty() ? options : options.substr(1));
+    string item;
+    for (int index = 0; std::getline(ss, item, ':'); ++index)
+    {
+        if (item.empty())
+            continue;
+        switch (index)
+        {
+            case 0:
+                config.seed = strtoull(item.c_str(), NULL, 10);
+                break;
+            case 1:
+            {
+                int width = 0, height = 0;
+                //larger sizes are clamped to 4K, a typo must not allocate a multi-GB background
+                if (sscanf(item.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0)
+                    config.size = Size(std::min(width, 3840), std::min(height, 2160));
+                break;
+            }
+            case 2:
+                config.frames  = std::max(1ul, strtoul(item.c_str(), NULL, 10));
+                break;
+            case 3:
+                config.objects = std::max(1ul, strtoul(item.c_str(), NULL, 10));
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+SyntheticInput::SyntheticInput(const SyntheticConfig &config, int colorFlag):
+Input(config.size, colorFlag), _config(config), _objects(), _background(), _occluder(), _frameN(0)
+{
+    _orgSize = _config.size;
+    
+    const int W = _config.size.width;
+    const int H = _config.size.height;
+    const int side = std::min(W, H);
+    
+    //the parameters of the objects are drawn first. The ground-truth only depends on them
+    RNG rng(0x5EED + _config.seed);
+    for (size_t i = 0; i < _config.objects; ++i)
+    {
+        Object object;
+        int w = std::max(8, cvRound(side / 6.0 * rng.uniform(0.7, 1.3)));
+        int h = std::max(8, cvRound(side / 6.0 * rng.uniform(0.7, 1.3)));
+        double radius = 0.5 * sqrt((double)(w * w + h * h)) * (1 + _config.scale);
+        
+        object.center    = Point2d(W / 2.0, H / 2.0);
+        object.amplitude = Point2d(std::max(0., W / 2.0 - radius) * rng.uniform(0.5, 0.95),
+                                   std::max(0., H / 2.0 - radius) * rng.uniform(0.5, 0.95));
+        object.frequency = Point2d(rng.uniform(0.5, 2.0), rng.uniform(0.5, 2.0));
+        object.phase     = Point2d(rng.uniform(0., 2 * CV_PI), rng.uniform(0., 2 * CV_PI));
+        object.scaleFrequency    = rng.uniform(0.5, 2.0);
+        object.scalePhase        = rng.uniform(0., 2 * CV_PI);
+        object.rotationFrequency = rng.uniform(0.5, 2.0);
+        object.rotationPhase     = rng.uniform(0., 2 * CV_PI);
+        
+        //textured object with some strong edges and corners
+        object.texture.create(h, w, CV_8UC3);
+        rng.fill(object.texture, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+        GaussianBlur(object.texture, object.texture, Size(0, 0), 1.5);
+        for (int k = 0; k < 8; ++k)
+        {
+            Point a(rng.uniform(0, w), rng.uniform(0, h));
+            Point b(rng.uniform(0, w), rng.uniform(0, h));
+            rectangle(object.texture, a, b,
+                      Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), CV_FILLED);
+        }
+        rectangle(object.texture, Point(0, 0), Point(w - 1, h - 1), Scalar::all(255), 2);
+        _objects.push_back(object);
+    }
+    
+    //smooth background built from upsampled noise and cluttered with distractor shapes
+    Mat coarse(std::max(2, H / 16), std::max(2, W / 16), CV_8UC3);
+    rng.fill(coarse, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    resize(coarse, _background, _config.size, 0, 0, INTER_LINEAR);
+    for (size_t k = 0; k < _config.clutter; ++k)
+    {
+        Point center(rng.uniform(0, W), rng.uniform(0, H));
+        int radius = rng.uniform(std::max(2, side / 40), std::max(3, side / 10));
+        Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        if (k % 2)
+            circle(_background, center, radius, color, CV_FILLED);
+        else
+            rectangle(_background, center, center + Point(radius, radius / 2 + 1), color, CV_FILLED);
+    }
+    
+    //striped occluder sized after the target
+    if (_config.occlusion && !_objects.empty())
+    {
+        const Mat &target = _objects[0].texture;
+        _occluder.create(std::max(target.rows, target.cols) * 3 / 2, std::max(4, target.cols * 3 / 5), CV_8UC3);
+        _occluder.setTo(Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)));
+        for (int y = 0; y < _occluder.rows; y += 8)
+            line(_occluder, Point(0, y), Point(_occluder.cols - 1, y), Scalar::all(rng.uniform(0, 256)), 2);
+    }
+}
+
+void SyntheticInput::transform(const Object &object, size_t frameN, Mat &M) const
+{
+    double t  = 2 * CV_PI * frameN / (double)std::max((size_t)1, _config.frames);
+    double cx = object.center.x + object.amplitude.x * sin(object.frequency.x * t + object.phase.x);
+    double cy = object.center.y + object.amplitude.y * sin(object.frequency.y * t + object.phase.y);
+    double s  = 1 + _config.scale * sin(object.scaleFrequency * t + object.scalePhase);
+    double a  = _config.rotation * sin(object.rotationFrequency * t + object.rotationPhase);
+    
+    Point2f pivot(object.texture.cols / 2.f, object.texture.rows / 2.f);
+    M = getRotationMatrix2D(pivot, a, s);
+    M.at<double>(0, 2) += cx - pivot.x;
+    M.at<double>(1, 2) += cy - pivot.y;
+}
+
+void SyntheticInput::getArea(size_t frameN, size_t object, vector<Point2f> &pts) const
+{
+    pts.clear();
+    if (object >= _objects.size())
+        return;
+    
+    Mat M;
+    transform(_objects[object], frameN, M);
+    const double *m = M.ptr<double>(0);
+    float w = (float)_objects[object].texture.cols;
+    float h = (float)_objects[object].texture.rows;
+    
+    Point2f corners[] = { Point2f(0, 0), Point2f(w, 0), Point2f(w, h), Point2f(0, h) };
+    for (int i = 0; i < 4; ++i)
+    {
+        pts.push_back(Point2f((float)(m[0] * corners[i].x + m[1] * corners[i].y + m[2]),
+                              (float)(m[3] * corners[i].x + m[4] * corners[i].y + m[5])));
+    }
+}
+
+void SyntheticInput::render(size_t frameN, Mat &frame) const
+{
+    const Rect bounds(Point(0, 0), _config.size);
+    _background.copyTo(frame);
+    
+    //object 0 is drawn last, on top of the other objects
+    for (size_t i = _objects.size(); i-- > 0;)
+    {
+        vector<Point2f> pts;
+        getArea(frameN, i, pts);
+        Rect roi = boundingRect(pts) & bounds;
+        if (roi.area() <= 0)
+            continue;
+        
+        Mat M;
+        transform(_objects[i], frameN, M);
+        M.at<double>(0, 2) -= roi.x;
+        M.at<double>(1, 2) -= roi.y;
+        Mat dst = frame(roi);
+        warpAffine(_objects[i].texture, dst, M, roi.size(), INTER_LINEAR, BORDER_TRANSPARENT);
+    }
+    
+    //the occluder sweeps the frame horizontally following the height of the target
+    if (!_occluder.empty())
+    {
+        vector<Point2f> pts;
+        getArea(frameN, 0, pts);
+        float cy = (pts[0].y + pts[1].y + pts[2].y + pts[3].y) / 4.f;
+        
+        size_t period = std::max((size_t)60, _config.frames / 4);
+        int x = -_occluder.cols + (int)((frameN % period) * (_config.size.width + _occluder.cols) / period);
+        Rect area(x, cvRound(cy) - _occluder.rows / 2, _occluder.cols, _occluder.rows);
+        Rect roi = area & bounds;
+        if (roi.area() > 0)
+            _occluder(roi - area.tl()).copyTo(frame(roi));
+    }
+    
+    if (_config.noise > 0)
+    {
+        RNG rng((0x5EED + _config.seed) ^ (0x9E3779B97F4A7C15ULL * (frameN + 1)));
+        Mat noise(frame.size(), CV_16SC3);
+        rng.fill(noise, RNG::NORMAL, Scalar::all(0), Scalar::all(_config.noise));
+        add(frame, noise, frame, noArray(), CV_8U);
+    }
+}
+
+bool SyntheticInput::getFrame(Mat &frame)
+{
+    if (_frameN >= _config.frames)
+        return false;
+    
+    render(_frameN++, frame);
+    _orgSize = frame.size();
+    if (_convert)
+        cvtColor(frame, frame, _conversionFlag);
+    return true;
+}
+
+void SyntheticInput::getGroundTruth(vector<vector<Point2f> > &gt, size_t object) const
+{
+    gt.resize(_config.frames);
+    for (size_t i = 0; i < _config.frames; ++i)
+        getArea(i, object, gt[i]);
+}
+
+void SyntheticInput::writeGroundTruth(const string &file, size_t object) const
+{
+    std::ofstream outfile(file.c_str());
+    outfile << std::setprecision(9);
+    vector<Point2f> pts;
+    for (size_t i = 0; i < _config.frames; ++i)
+    {
+        getArea(i, object, pts);
+        for (size_t k = 0; k < pts.size(); ++k)
+        {
+            outfile << pts[k].x << ", " << pts[k].y << ((k == (pts.size() - 1)) ? "" : ", ");
+        }
+        outfile << std::endl;
+    }
+}
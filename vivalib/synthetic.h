@@ -0,0 +1,166 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __viva__synthetic__
+#define __viva__synthetic__
+
+#include "input.h"
+#include <fstream>
+#include <cstdint>
+
+using namespace cv;
+using namespace std;
+
+namespace viva
+{
+    /**
+     * Parameters of a procedural synthetic sequence.
+     * The same parameters (including the seed) always generate the same frames.
+     */
+    struct SyntheticConfig
+    {
+        Size   size;        /**< frame resolution, clamped to 4K (3840x2160)*/
+        size_t frames;      /**< number of frames of the sequence*/
+        size_t objects;     /**< number of moving textured objects. Object 0 is the annotated target*/
+        uint64_t seed;      /**< random seed*/
+        double scale;       /**< relative amplitude of the scale changes, e.g., 0.3 is +-30%*/
+        double rotation;    /**< amplitude of the in-plane rotation in degrees*/
+        size_t clutter;     /**< number of distractor shapes in the background*/
+        bool   occlusion;   /**< an occluder periodically crosses the target*/
+        double noise;       /**< standard deviation of the gaussian camera noise. 0 disables it*/
+
+        SyntheticConfig(uint64_t seed_ = 0,
+                        const Size &size_ = Size(640, 480),
+                        size_t frames_ = 300,
+                        size_t objects_ = 1):
+            size(size_), frames(frames_), objects(objects_), seed(seed_),
+            scale(0.3), rotation(20), clutter(20), occlusion(true), noise(5)
+        {}
+
+        /**
+         * Parses a sequence description of the form
+         * synthetic[:seed[:WIDTHxHEIGHT[:frames[:objects]]]]
+         * e.g., synthetic:3:3840x2160:500:2
+         * @return false if the description is not a synthetic sequence
+         */
+        static bool parse(const string &description, SyntheticConfig &config);
+    };
+
+    /**
+     * SyntheticInput renders a seeded, deterministic sequence of textured objects
+     * moving along parametric paths with scale and rotation changes, over a cluttered
+     * background with occlusions and camera noise.
+     * The exact ground-truth of each object is available for every frame.
+     */
+    class SyntheticInput: public Input
+    {
+    private:
+        struct Object
+        {
+            Mat     texture;
+            Point2d center, amplitude, frequency, phase;
+            double  scaleFrequency, scalePhase;
+            double  rotationFrequency, rotationPhase;
+        };
+
+        SyntheticConfig _config;
+        vector<Object>  _objects;
+        Mat             _background;
+        Mat             _occluder;
+        size_t          _frameN;
+
+        /**
+         * Affine transformation from the object texture to the frame at frameN
+         */
+        void transform(const Object &object, size_t frameN, Mat &M) const;
+
+    public:
+        /**
+         * SyntheticInput constructor
+         * @param config: parameters of the sequence
+         * @param colorFlag: OpenCV conversion flag type value e.g., CV_BGR2GRAY
+         */
+        SyntheticInput(const SyntheticConfig &config = SyntheticConfig(), int colorFlag = -1);
+
+        /**
+         * Overrided from Input Base Class. Renders the next frame of the sequence.
+         * Returns false after the last frame.
+         * @param frame: output image frame from the sequence
+         */
+        bool getFrame(Mat &frame);
+
+        /**
+         * Overrided from Input Base Class. Frames are rendered independently, any frame can be next.
+         */
+        bool seek(size_t frameN)
+        {
+            if (frameN > _config.frames)
+                return false;
+            _frameN = frameN;
+            return true;
+        }
+
+        /**
+         * Renders any frame of the sequence. Frames can be accessed in any order.
+         */
+        void render(size_t frameN, Mat &frame) const;
+
+        /**
+         * Area of an object at frameN in clockwise order:
+         * topLeft -> topRight -> bottomRight -> bottomLeft of the object texture.
+         */
+        void getArea(size_t frameN, size_t object, vector<Point2f> &pts) const;
+
+        /**
+         * Ground-truth of an object for every frame of the sequence
+         */
+        void getGroundTruth(vector<vector<Point2f> > &gt, size_t object = 0) const;
+
+        /**
+         * Writes the ground-truth of an object in the format read by GroundTruth::parse
+         * (x1, y1, x2, y2, x3, y3, x4, y4 per line)
+         */
+        void writeGroundTruth(const string &file, size_t object = 0) const;
+
+        /**
+         * Number of frames of the sequence
+         */
+        size_t getNumberOfFrames() const
+        {
+            return _config.frames;
+        }
+    };
+}
+
+#endif /* defined(__viva__synthetic__) */
@@ -0,0 +1,297 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "thread_budget.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+using namespace viva;
+
+atomic<size_t> ThreadBudget::_limit(0);
+atomic<size_t> ThreadBudget::_leased(0);
+
+//zero when the thread was not started under a lease
+static thread_local size_t threadShare = 0;
+
+namespace
+{
+    /*
+     * Blocks of a ThreadBudget::parallel call. The workers of the pool and
+     * the calling thread claim blocks until none is left.
+     */
+    struct ParallelJob
+    {
+        const function<void(const Range&)> *body;
+        Range  range;
+        size_t blocks;
+        size_t share;
+        atomic<size_t> next;
+        size_t active;  //workers running the job, guarded by the pool mutex
+        vector<exception_ptr> errors;
+        
+        void run()
+        {
+            ThreadBudget::Scope scope(share);
+            int length = range.end - range.start;
+            for (size_t b = next++; b < blocks; b = next++)
+            {
+                Range r(range.start + (int)(length * b / blocks),
+                        range.start + (int)(length * (b + 1) / blocks));
+                try
+                {
+                    (*body)(r);
+                }
+                catch (...)
+                {
+                    errors[b] = current_exception();
+                }
+            }
+        }
+    };
+    
+    /*
+     * Persistent workers of ThreadBudget::parallel, started on demand up to the
+     * threads the budget can lease at once. The pool is never destroyed, idle
+     * workers wait for jobs until the process exits.
+     */
+    class WorkerPool
+    {
+    public:
+        WorkerPool(): _mutex(), _wake(), _done(), _queue(), _threads(0), _idle(0) {}
+        
+        /*
+         * Offers the job to up to helpers workers
+         */
+        void submit(ParallelJob &job, size_t helpers)
+        {
+            lock_guard<mutex> guard(_mutex);
+            _queue.insert(_queue.end(), helpers, &job);
+            //workers are started while the offers outnumber the idle ones
+            size_t limit = ThreadBudget::limit() - 1;
+            while (_queue.size() > _idle && _threads < limit)
+            {
+                thread(&WorkerPool::work, this).detach();
+                _threads++;
+                _idle++;
+            }
+            _wake.notify_all();
+        }
+        
+        /*
+         * Waits for the workers running the job. Offers not taken yet are
+         * withdrawn, the calling thread already ran their blocks.
+         */
+        void finish(ParallelJob &job)
+        {
+            unique_lock<mutex> lock(_mutex);
+            _queue.erase(std::remove(_queue.begin(), _queue.end(), &job), _queue.end());
+            _done.wait(lock, [&]() { return job.active == 0; });
+        }
+        
+    private:
+        void work()
+        {
+            unique_lock<mutex> lock(_mutex);
+            while (true)
+            {
+                _wake.wait(lock, [&]() { return !_queue.empty(); });
+                ParallelJob *job = _queue.front();
+                _queue.pop_front();
+                job->active++;
+                _idle--;
+                
+                lock.unlock();
+                job->run();
+                lock.lock();
+                
+                _idle++;
+                if (--job->active == 0)
+                    _done.notify_all();
+            }
+        }
+        
+        mutex _mutex;
+        condition_variable _wake;
+        condition_variable _done;
+        deque<ParallelJob*> _queue;
+        size_t _threads;
+        size_t _idle;
+    };
+    
+    WorkerPool *&workerPool()
+    {
+        static WorkerPool *pool = new WorkerPool();
+        return pool;
+    }
+}
+
+void ThreadBudget::setLimit(size_t threads)
+{
+    _limit = threads;
+}
+
+size_t ThreadBudget::limit()
+{
+    size_t threads = _limit;
+    if (threads == 0)
+        threads = std::max(1u, thread::hardware_concurrency());
+    return threads;
+}
+
+size_t ThreadBudget::available()
+{
+    //the main thread is never leased
+    size_t total  = limit() - 1;
+    size_t leased = _leased;
+    return (leased < total) ? total - leased : 0;
+}
+
+void ThreadBudget::detach(size_t threads)
+{
+    _limit  = std::max<size_t>(1, threads);
+    _leased = 0;
+    threadShare = 0;
+    //the workers of the parent do not exist in the child
+    workerPool() = new WorkerPool();
+}
+
+size_t ThreadBudget::share()
+{
+    return (threadShare > 0) ? threadShare : limit();
+}
+
+ThreadBudget::Lease::Lease(size_t requested):
+_threads(1), _extra(0), _share(1)
+{
+    size_t parent = ThreadBudget::share();
+    size_t wanted = (requested == 0) ? parent : std::min(requested, parent);
+    
+    if (wanted > 1)
+    {
+        size_t total  = ThreadBudget::limit() - 1;
+        size_t leased = _leased;
+        do
+        {
+            size_t free = (leased < total) ? total - leased : 0;
+            _extra = std::min(wanted - 1, free);
+        }
+        while (_extra > 0 && !_leased.compare_exchange_weak(leased, leased + _extra));
+    }
+    _threads = 1 + _extra;
+    _share   = std::max<size_t>(1, parent / _threads);
+}
+
+ThreadBudget::Lease::~Lease()
+{
+    _leased -= _extra;
+}
+
+ThreadBudget::OpenCVThreads::OpenCVThreads(size_t share):
+_previous(-1)
+{
+    //threads started under a lease run inside a stage which already set it
+    if (threadShare > 0)
+        return;
+    _previous = getNumThreads();
+    setNumThreads((int)std::max<size_t>(1, share));
+}
+
+ThreadBudget::OpenCVThreads::~OpenCVThreads()
+{
+    if (_previous >= 0)
+        setNumThreads(_previous);
+}
+
+ThreadBudget::Scope::Scope(size_t share):
+_previous(threadShare)
+{
+    threadShare = std::max<size_t>(1, share);
+#ifdef _OPENMP
+    omp_set_num_threads((int)threadShare);
+#endif
+}
+
+ThreadBudget::Scope::~Scope()
+{
+    threadShare = _previous;
+#ifdef _OPENMP
+    omp_set_num_threads((int)ThreadBudget::share());
+#endif
+}
+
+void ThreadBudget::parallel(const Range &range,
+                            const function<void(const Range&)> &body,
+                            size_t requested)
+{
+    int length = range.end - range.start;
+    if (length <= 0)
+        return;
+    if (requested == 0 || requested > (size_t)length)
+        requested = length;
+    
+    Lease lease(requested);
+    size_t blocks = lease.threads();
+    if (blocks == 1)
+    {
+        body(range);
+        return;
+    }
+    
+    ParallelJob job;
+    job.body   = &body;
+    job.range  = range;
+    job.blocks = blocks;
+    job.share  = lease.share();
+    job.next   = 0;
+    job.active = 0;
+    job.errors.resize(blocks);
+    
+    WorkerPool &pool = *workerPool();
+    pool.submit(job, blocks - 1);
+    job.run();
+    pool.finish(job);
+    
+    for (size_t b = 0; b < blocks; ++b)
+        if (job.errors[b])
+            rethrow_exception(job.errors[b]);
+}
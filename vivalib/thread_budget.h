@@ -0,0 +1,167 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __viva__thread_budget__
+#define __viva__thread_budget__
+
+#include "opencv2/core/core.hpp"
+#include <atomic>
+#include <functional>
+
+using namespace std;
+using namespace cv;
+
+namespace viva
+{
+    /**
+     * Project-wide budget of worker threads.
+     *
+     * Every parallel stage (evaluation jobs, the Processor pipeline, the
+     * channel loops of the trackers) leases its workers from a single
+     * global count instead of spawning as many threads as cores. The
+     * main thread owns the whole budget; a lease splits the share of the
+     * calling thread among the leased threads, so nested stages only get
+     * what the outer ones left and concurrent runs never oversubscribe.
+     */
+    class ThreadBudget
+    {
+    public:
+        /**
+         * Sets the total number of threads of the process.
+         * A value of zero uses the number of hardware threads.
+         */
+        static void setLimit(size_t threads);
+        /**
+         * Total number of threads of the process
+         */
+        static size_t limit();
+        /**
+         * Threads not leased yet by any stage
+         */
+        static size_t available();
+        /**
+         * Number of threads the calling thread may use, itself included
+         */
+        static size_t share();
+        /**
+         * Restarts the budget of a forked worker process with the given
+         * number of threads. The leases of the parent are never released
+         * in the child, so they are dropped from its count, and the workers
+         * of the parallel pool do not exist in the child, so a new pool is used.
+         */
+        static void detach(size_t threads);
+        
+        /**
+         * Workers leased by a parallel stage for the lifetime of the object.
+         * The calling thread always counts as one of them, so a lease never
+         * grants less than one thread and never blocks.
+         */
+        class Lease
+        {
+        public:
+            /**
+             * Leases up to requested threads (zero requests the whole share
+             * of the calling thread).
+             */
+            explicit Lease(size_t requested);
+            ~Lease();
+            /**
+             * Number of granted threads, the calling thread included
+             */
+            size_t threads() const { return _threads; }
+            /**
+             * Share of each leased thread to be set with a Scope
+             */
+            size_t share() const { return _share; }
+            
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+        private:
+            size_t _threads;
+            size_t _extra;
+            size_t _share;
+        };
+        
+        /**
+         * Limits the OpenCV pool to the share of each job of a runner for the
+         * lifetime of the object. The setting is global to the process, so only
+         * the outermost stage (a thread not started under a lease) changes it;
+         * nested stages keep it. Runners set it once, before starting their jobs.
+         */
+        class OpenCVThreads
+        {
+        public:
+            explicit OpenCVThreads(size_t share);
+            ~OpenCVThreads();
+            
+            OpenCVThreads(const OpenCVThreads&) = delete;
+            OpenCVThreads& operator=(const OpenCVThreads&) = delete;
+        private:
+            int _previous;
+        };
+        
+        /**
+         * Sets the share of the calling thread (and its OpenMP limit) for the
+         * lifetime of the object. Workers started under a lease create one
+         * with the share of the lease.
+         */
+        class Scope
+        {
+        public:
+            explicit Scope(size_t share);
+            ~Scope();
+            
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        private:
+            size_t _previous;
+        };
+        
+        /**
+         * Runs body over contiguous blocks of range with the threads leased
+         * for the calling thread (at most requested, zero for the whole
+         * share). The blocks run on a pool of persistent workers and on the
+         * calling thread, which takes any block the pool has not started.
+         * The body is called on the calling thread when no workers are granted.
+         */
+        static void parallel(const Range &range,
+                             const function<void(const Range&)> &body,
+                             size_t requested = 0);
+    private:
+        static atomic<size_t> _limit;
+        static atomic<size_t> _leased;
+    };
+}
+
+#endif
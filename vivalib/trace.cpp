@@ -0,0 +1,200 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#include "trace.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+using namespace viva;
+
+atomic<bool> Trace::_enabled(false);
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char *name;
+        int64_t     begin;
+        int64_t     duration;
+    };
+    
+    /**
+     * Fixed size block of events. Only the owner thread appends events,
+     * publishing them through count and next.
+     */
+    struct TraceBlock
+    {
+        static const size_t CAPACITY = 4096;
+        TraceEvent          events[CAPACITY];
+        atomic<size_t>      count;
+        atomic<TraceBlock*> next;
+        TraceBlock(): count(0), next(NULL) {}
+    };
+    
+    struct TraceBuffer
+    {
+        size_t      tid;
+        TraceBlock *first;
+        TraceBlock *last;
+    };
+    
+    /**
+     * Buffers of every thread that recorded an event. Never released, so
+     * the buffers outlive their threads and are still valid at exit.
+     */
+    struct TraceRegistry
+    {
+        mutex                 access;
+        vector<TraceBuffer*>  buffers;
+        string                filename;
+        bool                  registered = false;
+    };
+    
+    TraceRegistry &registry()
+    {
+        static TraceRegistry *instance = new TraceRegistry();
+        return *instance;
+    }
+    
+    TraceBuffer *threadBuffer()
+    {
+        static thread_local TraceBuffer *buffer = NULL;
+        if (!buffer)
+        {
+            buffer = new TraceBuffer();
+            buffer->first = buffer->last = new TraceBlock();
+            TraceRegistry &r = registry();
+            lock_guard<mutex> guard(r.access);
+            buffer->tid = r.buffers.size();
+            r.buffers.push_back(buffer);
+        }
+        return buffer;
+    }
+    
+    void writeName(ostream &out, const char *name)
+    {
+        out << '"';
+        for (const char *c = name; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                out << '\\';
+            out << *c;
+        }
+        out << '"';
+    }
+    
+    void closeAtExit()
+    {
+        Trace::close();
+    }
+}
+
+void Trace::open(const string &filename)
+{
+#ifndef VIVA_TRACE
+    cerr << "Trace events are only recorded when built with WITH_TRACE" << endl;
+#endif
+    TraceRegistry &r = registry();
+    lock_guard<mutex> guard(r.access);
+    r.filename = filename;
+    if (!r.registered)
+    {
+        atexit(closeAtExit);
+        r.registered = true;
+    }
+    _enabled = true;
+}
+
+void Trace::close()
+{
+    if (!_enabled.exchange(false))
+        return;
+    
+    TraceRegistry &r = registry();
+    lock_guard<mutex> guard(r.access);
+    ofstream out(r.filename.c_str());
+    if (!out.is_open())
+    {
+        cerr << "Could not write the trace file: " << r.filename << endl;
+        return;
+    }
+    
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (size_t b = 0; b < r.buffers.size(); ++b)
+    {
+        for (TraceBlock *block = r.buffers[b]->first; block; block = block->next.load(std::memory_order_acquire))
+        {
+            size_t count = block->count.load(std::memory_order_acquire);
+            for (size_t e = 0; e < count; ++e)
+            {
+                const TraceEvent &event = block->events[e];
+                out << (first ? "\n" : ",\n") << "{\"name\":";
+                writeName(out, event.name);
+                out << ",\"cat\":\"viva\",\"ph\":\"X\",\"pid\":0,\"tid\":" << r.buffers[b]->tid
+                    << ",\"ts\":" << event.begin << ",\"dur\":" << event.duration << "}";
+                first = false;
+            }
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+int64_t Trace::now()
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(const char *name, int64_t begin, int64_t end)
+{
+    TraceBuffer *buffer = threadBuffer();
+    TraceBlock  *block  = buffer->last;
+    size_t count = block->count.load(std::memory_order_relaxed);
+    if (count == TraceBlock::CAPACITY)
+    {
+        TraceBlock *next = new TraceBlock();
+        block->next.store(next, std::memory_order_release);
+        buffer->last = block = next;
+        count = 0;
+    }
+    TraceEvent &event = block->events[count];
+    event.name     = name;
+    event.begin    = begin;
+    event.duration = end - begin;
+    block->count.store(count + 1, std::memory_order_release);
+}
@@ -0,0 +1,119 @@
+/**************************************************************************************************
+ **************************************************************************************************
+ 
+     BSD 3-Clause License (https://www.tldrlegal.com/l/bsd3)
+     
+     Copyright (c) 2015 Andrés Solís Montero <http://www.solism.ca>, All rights reserved.
+     
+     
+     Redistribution and use in source and binary forms, with or without modification,
+     are permitted provided that the following conditions are met:
+     
+     1. Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice,
+        this list of conditions and the following disclaimer in the documentation
+        and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors
+        may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+     
+     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+     AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+     IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+     ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+     LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+     DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+     THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+     OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+     OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+ **************************************************************************************************
+ **************************************************************************************************/
+
+#ifndef __viva__trace__
+#define __viva__trace__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+/**
+ * Scoped timers recorded as Chrome trace events (chrome://tracing, Perfetto).
+ * They are compiled out unless the project is configured with WITH_TRACE,
+ * and record nothing until Trace::open is called. The name must be a string
+ * with static storage (a literal or __FUNCTION__).
+ */
+#ifdef VIVA_TRACE
+    #define VIVA_TRACE_CONCAT_(a, b) a##b
+    #define VIVA_TRACE_CONCAT(a, b)  VIVA_TRACE_CONCAT_(a, b)
+    #define VIVA_TRACE_SCOPE(name)   viva::TraceScope VIVA_TRACE_CONCAT(_traceScope, __LINE__)(name)
+    #define VIVA_TRACE_FUNCTION()    VIVA_TRACE_SCOPE(__FUNCTION__)
+#else
+    #define VIVA_TRACE_SCOPE(name)
+    #define VIVA_TRACE_FUNCTION()
+#endif
+
+namespace viva
+{
+    /**
+     * Collector of the trace events of the process.
+     * Each thread appends its events to its own buffer without locking;
+     * the buffers are exported as trace-event JSON when the trace is closed
+     * or at exit.
+     */
+    class Trace
+    {
+    public:
+        /**
+         * Starts recording the events. They are written to filename
+         * by close() or when the process exits.
+         */
+        static void open(const string &filename);
+        /**
+         * Writes the recorded events and stops recording.
+         * The threads recording events should be joined before.
+         */
+        static void close();
+        /**
+         * True while events are recorded
+         */
+        static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+        /**
+         * Microseconds of a monotonic clock
+         */
+        static int64_t now();
+        /**
+         * Records a complete event of the calling thread
+         */
+        static void record(const char *name, int64_t begin, int64_t end);
+    private:
+        static atomic<bool> _enabled;
+    };
+    
+    /**
+     * Records the lifetime of the object as an event, used by VIVA_TRACE_SCOPE
+     */
+    class TraceScope
+    {
+    public:
+        explicit TraceScope(const char *name):
+        _name(Trace::enabled() ? name : NULL), _begin(_name ? Trace::now() : 0)
+        {}
+        ~TraceScope()
+        {
+            if (_name)
+                Trace::record(_name, _begin, Trace::now());
+        }
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+    private:
+        const char *_name;
+        int64_t     _begin;
+    };
+}
+
+#endif
@@ -34,6 +34,15 @@
 
 #include "utils.h"
 
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 using namespace viva;
 
 const int Keys::ESC   = 27;
@@ -204,5 +213,100 @@ void Files::getFilename(const string &path, string &filename)
     filename = path.substr(index + 1);
 }
 
+time_t Files::modificationTime(const string &fullpath)
+{
+    struct stat st;
+    if (stat(fullpath.c_str(), &st) != 0)
+        return 0;
+    return st.st_mtime;
+}
+
+bool Files::stamp(const string &fullpath, int64_t &size, int64_t &mtime)
+{
+    struct stat st;
+    if (stat(fullpath.c_str(), &st) != 0)
+        return false;
+    size  = (int64_t)st.st_size;
+    mtime = (int64_t)st.st_mtime * 1000000000;
+#if defined(__APPLE__)
+    mtime += st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    mtime += st.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+MappedFile::MappedFile(const string &filename):
+_data(NULL), _size(0), _open(false)
+#ifdef _WIN32
+, _file(INVALID_HANDLE_VALUE), _mapping(NULL)
+#endif
+{
+#ifdef _WIN32
+    _file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (_file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size))
+        return;
+    _size = (size_t)size.QuadPart;
+    _open = true;
+    if (_size == 0)
+        return;
+    _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (_mapping != NULL)
+        _data = (const char *)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+    _open = (_data != NULL);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        _size = (size_t)st.st_size;
+        _open = true;
+        if (_size > 0)
+        {
+            void *data = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, _size, MADV_SEQUENTIAL);
+                _data = (const char *)data;
+            }
+            else
+                _open = false;
+        }
+    }
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (_data != NULL)
+        UnmapViewOfFile(_data);
+    if (_mapping != NULL)
+        CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE)
+        CloseHandle(_file);
+#else
+    if (_data != NULL)
+        munmap((void *)_data, _size);
+#endif
+}
 
+void MappedFile::willNeed(size_t offset, size_t length) const
+{
+#ifndef _WIN32
+    if (_data == NULL || offset >= _size)
+        return;
+    length = std::min(length, _size - offset);
+    size_t page  = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset - offset % page;
+    madvise((void *)(_data + begin), length + (offset - begin), MADV_WILLNEED);
+#endif
+}
 
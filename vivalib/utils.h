@@ -40,6 +40,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <cstdint>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -130,6 +131,46 @@ namespace viva
          * Returns the basename of file in the path
          */
         static void getBasename(const string &path, string &base);
+        /**
+         * Returns the last modification time of the path, 0 if it does not exist
+         */
+        static time_t modificationTime(const string &fullpath);
+        /**
+         * Returns the size and the last modification time in nanoseconds of the path
+         * (seconds resolution where the platform does not provide more).
+         * @return false if it does not exist
+         */
+        static bool stamp(const string &fullpath, int64_t &size, int64_t &mtime);
+    };
+    
+    /**
+     * Read-only memory mapping of a whole file.
+     * The content is available through data() while the object is alive.
+     */
+    class MappedFile
+    {
+    private:
+        const char *_data;
+        size_t _size;
+        bool _open;
+#ifdef _WIN32
+        void *_file;
+        void *_mapping;
+#endif
+        MappedFile(const MappedFile &);
+        MappedFile &operator=(const MappedFile &);
+        
+    public:
+        MappedFile(const string &filename);
+        ~MappedFile();
+        
+        bool isOpen() const { return _open; }
+        const char *data() const { return _data; }
+        size_t size() const { return _size; }
+        /**
+         * Hints the system to read ahead a range of the file. No-op where it is not supported.
+         */
+        void willNeed(size_t offset, size_t length) const;
     };
     
     
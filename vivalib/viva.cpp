@@ -49,7 +49,11 @@ void ProcessInput::operator()()
         Mat frame;
         auto start_time = chrono::high_resolution_clock::now();
         
-        bool hasFrame = _input->getFrame(frame);
+        bool hasFrame;
+        {
+            VIVA_TRACE_SCOPE("ProcessInput::getFrame");
+            hasFrame = _input->getFrame(frame);
+        }
 
         auto end_time = chrono::high_resolution_clock::now();
         auto duration = chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
@@ -85,7 +89,10 @@ void ProcessOutput::operator()()
         else
         {
             auto start_time = chrono::high_resolution_clock::now();
-            _output->writeFrame(frame);
+            {
+                VIVA_TRACE_SCOPE("ProcessOutput::writeFrame");
+                _output->writeFrame(frame);
+            }
             auto end_time = chrono::high_resolution_clock::now();
             auto duration = chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
             _channel->setFrequency((float)(1000.0/double(duration)));
@@ -138,6 +145,10 @@ void Processor::run()
     if (!_input && (!_process || !_functor))
         return;
     
+    //the input and output stages take one thread each from the budget
+    ThreadBudget::Lease stages(3);
+    ThreadBudget::Scope processing(ThreadBudget::share() - stages.threads() + 1);
+    
     Ptr<BufferedImageChannel> _input_channel = new BufferedImageChannel(_inputBufferSize);
     std::thread  _inputThread(ProcessInput(_input, _input_channel));
     thread_guard gi(_inputThread);
@@ -181,10 +192,13 @@ void Processor::run()
                 cv::imshow(_inputWindowName, frame);
             auto start_time = chrono::high_resolution_clock::now();
 
-            if (_functor)
-                _functor(frameN, frame, frameOut);
-            else if (_process)
-                _process->operator()(frameN, frame, frameOut);
+            {
+                VIVA_TRACE_SCOPE("Processor::process");
+                if (_functor)
+                    _functor(frameN, frame, frameOut);
+                else if (_process)
+                    _process->operator()(frameN, frame, frameOut);
+            }
             
             auto end_time = chrono::high_resolution_clock::now();
             auto duration = chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
@@ -196,7 +210,10 @@ void Processor::run()
                        _output_channel->getFrequency());
             
             if (_showOutput && !frameOut.empty())
+            {
+                VIVA_TRACE_SCOPE("Processor::display");
                 cv::imshow(_outputWindowName, frameOut);
+            }
             if (_output)
                 _output_channel->addData(frameOut);
             
@@ -276,6 +293,10 @@ void BatchProcessor::run()
     if (!_input && (!_batch_process || !_batch_functor))
         return;
     
+    //the input and output stages take one thread each from the budget
+    ThreadBudget::Lease stages(3);
+    ThreadBudget::Scope processing(ThreadBudget::share() - stages.threads() + 1);
+    
     Ptr<BufferedImageChannel> _input_channel = new BufferedImageChannel(_inputBufferSize);
     std::thread  _inputThread(ProcessInput(_input, _input_channel));
     thread_guard gi(_inputThread);
@@ -332,10 +353,13 @@ void BatchProcessor::run()
                 cv::imshow(_inputWindowName, frames[numberOfFrames - 1]);
             auto start_time = chrono::high_resolution_clock::now();
             
-            if (_batch_functor)
-                _batch_functor(frameN, frames, frameOut);
-            else if (_batch_process)
-                _batch_process->operator()(frameN, frames, frameOut);
+            {
+                VIVA_TRACE_SCOPE("BatchProcessor::process");
+                if (_batch_functor)
+                    _batch_functor(frameN, frames, frameOut);
+                else if (_batch_process)
+                    _batch_process->operator()(frameN, frames, frameOut);
+            }
             
             auto end_time = chrono::high_resolution_clock::now();
             auto duration = chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
@@ -347,7 +371,10 @@ void BatchProcessor::run()
                        _output_channel->getFrequency());
             
             if (_showOutput && !frameOut.empty())
+            {
+                VIVA_TRACE_SCOPE("Processor::display");
                 cv::imshow(_outputWindowName, frameOut);
+            }
             if (_output)
                 _output_channel->addData(frameOut);
 
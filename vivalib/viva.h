@@ -43,6 +43,10 @@
 #include "listener.h"
 #include "output.h"
 #include "channel.h"
+#include "synthetic.h"
+#include "packed.h"
+#include "thread_budget.h"
+#include "trace.h"
 
 
 using namespace std;